@@ -14,13 +14,30 @@
 #include "hardware/pwm.h"            // biblioteca para controle de PWM (Pulse Width Modulation)
 #include <stdio.h>                   // biblioteca padrão de entrada e saída (para printf)
 #include <string.h>                  // biblioteca para manipulação de strings (para strcmp, strlen, etc.)
-#include <stdlib.h>                  // biblioteca para funções de utilidade geral (para atof)
-#include <math.h>                    // biblioteca para funções matemáticas (para pow)
+#include <stdlib.h>                  // biblioteca para funções de utilidade geral (para strtoul)
+#include <math.h>                    // biblioteca para funções matemáticas (para isfinite)
 #include "aht20.h"                   // driver para o sensor de umidade AHT20
 #include "bmp280.h"                  // driver para o sensor de pressão e temperatura BMP280
+#include "sensors.h"                 // máquina de estados de aquisição não bloqueante dos sensores
+#include "spsc_ring.h"               // fila sem travas entre os dois núcleos
+#include "history.h"                 // histórico das medições em RAM
+#include "rollup.h"                  // agregados mín/máx/média por minuto e por hora
+#include "flashlog.h"                // registro das amostras na flash (persiste entre boots)
+#include "httpd.h"                   // servidor HTTP/1.1 com conexões persistentes
+#include "fmt.h"                     // formatação de números em ponto fixo, sem printf de float
+#include "altitude.h"                // altitude barométrica por tabela, em ponto fixo
+#include "led_matrix.h"              // framebuffer da matriz WS2812 com envio por DMA
+#include "sequencer.h"               // padrões do LED RGB e do buzzer por alarmes do timer
+#include "alerts.h"                  // regras de alerta com histerese, espera e variação na janela
+#include "metrics.h"                 // contadores e histogramas de latência servidos em /metrics
 #include "ssd1306.h"                 // driver para o display OLED SSD1306
 #include "font.h"                    // fonte de caracteres para o display OLED
 #include "generated/ws2812.pio.h"    // programa PIO pré-compilado para o LED WS2812
+#include "generated/web_assets.h"    // páginas web de web/, comprimidas com gzip no build
+#if ESTACAO_DUAL_CORE
+#include "pico/multicore.h"          // biblioteca para iniciar o segundo núcleo (aquisição e interface local)
+#include "pico/flash.h"              // pausa do núcleo 1 durante apagamentos e gravações da flash
+#endif
 
 // --- Definições de Pinos ---
 #define WS2812_PIN 7                 // pino GPIO conectado ao pino de dados do LED Neopixel WS2812
@@ -39,183 +56,227 @@
 #define I2C_PORT_SENSORES i2c0       // porta I2C 0 usada para os sensores
 #define I2C_SDA_SENSORES 0           // pino GPIO para a linha de dados (SDA) do I2C dos sensores
 #define I2C_SCL_SENSORES 1           // pino GPIO para a linha de clock (SCL) do I2C dos sensores
+#define PERIODO_AMOSTRAGEM_MS 500    // intervalo entre as leituras dos sensores
+#define TICK_LOOP_MS 5               // pausa de cada passagem do loop principal
 
 // --- Variáveis Globais ---
-float temperatura_bmp = 0.0, umidade_aht = 0.0; // armazenam os valores lidos dos sensores
-float pressao_bmp = 0.0, altitude_bmp = 0.0;    // armazenam os valores lidos e calculados
-float temp_lim_min = 18.0, temp_lim_max = 40.0; // limites de temperatura para o sistema de alerta
-float umid_lim_min = 30.0, umid_lim_max = 70.0; // limites de umidade para o sistema de alerta
-float press_lim_min = 950.0, press_lim_max = 1050.0; // limites de pressão para o sistema de alerta
+// medições e limites em ponto fixo: centésimos de °C, centésimos de %, Pa e cm
+int32_t temperatura_bmp = 0, umidade_aht = 0;   // armazenam os valores lidos dos sensores
+int32_t pressao_bmp = 0, altitude_bmp = 0;      // armazenam os valores lidos e calculados
+int32_t pressao_nivel_mar = ALTITUDE_SEA_LEVEL_PA; // referência ao nível do mar para a altitude (Pa), no núcleo de aquisição
 bool alerta_ativo = false;                         // flag que indica se o alerta está ativo (true) ou não (false)
 char ip_str[16] = "?.?.?.?";                       // string para armazenar o endereço IP do dispositivo
 enum { MENU_PRINCIPAL, TELA_MONITORAMENTO, TELA_LIMITES } estado_menu = MENU_PRINCIPAL; // controla qual tela principal é exibida no OLED
 
+// --- Regras de Alerta ---
+// a ordem da tabela é a prioridade na sinalização: a primeira regra disparada escolhe o
+// padrão do LED RGB e do buzzer e o texto do display
+enum {
+    REGRA_TEMP_MAX, REGRA_TEMP_MIN, REGRA_UMID_MAX, REGRA_UMID_MIN,
+    REGRA_PRESS_MAX, REGRA_PRESS_MIN, REGRA_PRESS_QUEDA, NUM_REGRAS
+};
+// canais avaliados, todos em centésimos da unidade mostrada: °C, %, hPa (= Pa) e m (= cm)
+enum { CANAL_TEMP, CANAL_UMID, CANAL_PRESS, CANAL_ALT };
+
+// tipo, canal, ativa, limite, histerese, espera (ms) e janela (s) de cada regra
+static const alert_rule_config_t regras_padrao[NUM_REGRAS] = {
+    [REGRA_TEMP_MAX]    = { ALERT_ABOVE, CANAL_TEMP, true, 4000, 50, 2000, 0 },
+    [REGRA_TEMP_MIN]    = { ALERT_BELOW, CANAL_TEMP, true, 1800, 50, 2000, 0 },
+    [REGRA_UMID_MAX]    = { ALERT_ABOVE, CANAL_UMID, true, 7000, 100, 2000, 0 },
+    [REGRA_UMID_MIN]    = { ALERT_BELOW, CANAL_UMID, true, 3000, 100, 2000, 0 },
+    [REGRA_PRESS_MAX]   = { ALERT_ABOVE, CANAL_PRESS, true, 105000, 50, 2000, 0 },
+    [REGRA_PRESS_MIN]   = { ALERT_BELOW, CANAL_PRESS, true, 95000, 50, 2000, 0 },
+    // queda de mais de 3 hPa em 3 horas: tendência de mau tempo
+    [REGRA_PRESS_QUEDA] = { ALERT_FALL, CANAL_PRESS, true, 300, 100, 0, 3 * 3600 },
+};
+static const char *const nomes_regras[NUM_REGRAS] = {      // chaves na interface web
+    "temp_max", "temp_min", "umid_max", "umid_min", "press_max", "press_min", "press_queda",
+};
+static const char *const rotulos_regras[NUM_REGRAS] = {    // texto no display (até 15 caracteres)
+    "Temp alta", "Temp baixa", "Umid alta", "Umid baixa", "Press alta", "Press baixa", "Press caindo",
+};
+
+// motor das regras, só no núcleo de aquisição: uma amostra por minuto para as regras de
+// variação, com janela máxima de 3 horas
+#define PERIODO_JANELA_REGRAS_S 60
+#define TAMANHO_JANELA_REGRAS 181
+static alert_rule_t regras[NUM_REGRAS];
+static alert_point_t janela_regras[TAMANHO_JANELA_REGRAS];
+static alerts_t alertas;
+
+// configuração das regras vista pelo servidor web (núcleo 0); cada edição segue pela fila
+// para o motor do núcleo de aquisição, que aplica as edições antes de avaliar a próxima amostra
+static alert_rule_config_t regras_config[NUM_REGRAS];
+typedef struct {
+    uint32_t indice;
+    alert_rule_config_t config;
+} edicao_regra_t;
+#define TAMANHO_FILA_REGRAS 32                     // capacidade da fila de edições (potência de 2)
+static edicao_regra_t fila_regras_buffer[TAMANHO_FILA_REGRAS];
+static spsc_ring_t fila_regras;                    // núcleo 0 (produtor) -> núcleo 1 (consumidor)
+
+// pressão ao nível do mar vista pelo servidor web; cada troca segue pela fila para o núcleo
+// de aquisição, como as edições de regras
+#define PRESSAO_MAR_MIN_PA 80000                   // faixa aceita na configuração (800 a 1100 hPa)
+#define PRESSAO_MAR_MAX_PA 110000
+static int32_t pressao_nivel_mar_config = ALTITUDE_SEA_LEVEL_PA;
+#define TAMANHO_FILA_PRESSAO_MAR 4                 // capacidade da fila (potência de 2)
+static int32_t fila_pressao_mar_buffer[TAMANHO_FILA_PRESSAO_MAR];
+static spsc_ring_t fila_pressao_mar;               // núcleo 0 (produtor) -> núcleo 1 (consumidor)
+
+// amostra processada, publicada pelo núcleo de aquisição para o servidor web
+typedef struct {
+    uint64_t timestamp_us;                         // instante da leitura (desde o boot)
+    int32_t temp_c100;                             // centésimos de °C
+    int32_t umid_c100;                             // centésimos de %
+    int32_t press_pa;                              // Pa
+    int32_t alt_cm;                                // cm
+    uint32_t regras_ativas;                        // bit i: regra i disparada
+    bool alerta;
+} amostra_t;
+
+#define TAMANHO_FILA_AMOSTRAS 16                   // capacidade da fila entre os núcleos (potência de 2)
+static amostra_t fila_amostras_buffer[TAMANHO_FILA_AMOSTRAS];
+static spsc_ring_t fila_amostras;                  // núcleo 1 (produtor) -> núcleo 0 (consumidor)
+static amostra_t ultima_amostra;                   // última amostra vista pelo servidor web (núcleo 0)
+
+// histórico servido em /history: uma amostra a cada PERIODO_HISTORICO_MS, cerca de 3 horas
+#define PERIODO_HISTORICO_MS 2000
+#define TAMANHO_HISTORICO 5400
+#define HISTORICO_MAX_POR_RESPOSTA 48              // registros por resposta de /history (~50 bytes cada)
+static history_record_t historico_buffer[TAMANHO_HISTORICO];
+static history_t historico;
+static uint64_t proximo_historico_us = 0;          // instante a partir do qual a próxima amostra entra no histórico
+
+// agregados servidos em /rollup: baldes de 1 minuto por 6 horas e de 1 hora por 7 dias
+// (a soma de 32 bits comporta uma hora de pressão em Pa mesmo a 2 amostras/s)
+#define AGREGADOS_MINUTO 360
+#define AGREGADOS_HORA 168
+#define AGREGADOS_MAX_POR_RESPOSTA 24              // baldes por resposta de /rollup (~100 bytes cada)
+static rollup_bucket_t agregados_minuto[AGREGADOS_MINUTO];
+static rollup_bucket_t agregados_hora[AGREGADOS_HORA];
+static rollup_tier_t camadas_agregados[2];
+static rollup_t agregados;
+
+// registro persistente em /log: os registros do histórico também vão para o último 256 KB
+// da flash (cerca de 11 horas; cada setor é apagado uma vez a cada volta do log)
+#define REGISTRO_FLASH_TAMANHO (256 * 1024)
+#define REGISTRO_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - REGISTRO_FLASH_TAMANHO)
+static flashlog_t registro_flash;
+static bool registro_flash_ok = false;
+
+// métricas de execução servidas em /metrics; cada uma é escrita por um só núcleo (o da
+// aquisição para sensores, display, matriz e laço do núcleo 1; o da rede para o resto)
+static const uint32_t baldes_leitura_us[] = { 250, 500, 1000, 2000, 4000, 8000 };    // transações I2C
+static const uint32_t baldes_envio_us[] = { 10, 25, 50, 100, 250, 1000 };            // disparo de DMA
+static const uint32_t baldes_http_us[] = { 100, 250, 500, 1000, 2500, 10000 };       // recepção HTTP
+static const uint32_t baldes_laco_us[] = { 5250, 5500, 6000, 7500, 10000, 25000 };   // TICK_LOOP_MS + trabalho
+static metrics_histogram_t metrica_leitura_bmp = METRICS_HISTOGRAM(baldes_leitura_us);
+static metrics_histogram_t metrica_leitura_aht = METRICS_HISTOGRAM(baldes_leitura_us);
+static metrics_histogram_t metrica_display = METRICS_HISTOGRAM(baldes_envio_us);
+static metrics_histogram_t metrica_matriz = METRICS_HISTOGRAM(baldes_envio_us);
+static metrics_histogram_t metrica_http = METRICS_HISTOGRAM(baldes_http_us);
+static metrics_histogram_t metrica_laco[2] = { METRICS_HISTOGRAM(baldes_laco_us), METRICS_HISTOGRAM(baldes_laco_us) };
+static metrics_counter_t metrica_leituras_bmp, metrica_leituras_aht; // leituras brutas combinadas nas amostras
+static metrics_counter_t metrica_amostras;         // amostras publicadas para o servidor web
+static metrics_counter_t metrica_descartes;        // amostras descartadas com a fila entre os núcleos cheia
+static metrics_counter_t metrica_requisicoes, metrica_recusas;
+static metrics_gauge_t metrica_uptime, metrica_conexoes, metrica_memoria_conexoes, metrica_memoria_reservada;
+static metrics_gauge_t metrica_regras_ativas;
+
 int tela_monitor_sub_estado = 0; // controla qual subtela de monitoramento é exibida (0:Temp, 1:Umid, 2:Pressão, 3:Altitude)
 int tela_limites_sub_estado = 0; // controla qual subtela de limites é exibida (0:Temp, 1:Umid, 2:Pressão, 3:IP)
-
-// --- Páginas HTML ---
-// string C contendo o código HTML para a página principal (dashboard)
-const char HTML_PAGE[] =
-    "<!DOCTYPE html>\n"
-    "<html lang=\"pt-br\">\n"
-    "<head>\n"
-    "    <meta charset=\"UTF-8\">\n"
-    "    <meta name=\"viewport\" content=\"width=device-width,initial-scale=1\">\n"
-    "    <title>Estação Meteorológica</title>\n"
-    "    <script src=\"https://cdn.jsdelivr.net/npm/chart.js\"></script>\n"
-    "    <style>\n"
-    "        body{font-family:sans-serif;background-color:#f0f2f5;display:flex;flex-direction:column;align-items:center;padding:20px}\n"
-    "        h1{color:#333}\n"
-    "        .container{display:grid;grid-template-columns:repeat(auto-fit,minmax(320px,1fr));gap:20px;width:100%;max-width:1400px}\n"
-    "        .data-block{background-color:#fff;border-radius:10px;box-shadow:0 4px 6px rgba(0,0,0,.1);padding:20px;text-align:center}\n"
-    "        h2{margin-top:0;font-size:1.1em;color:#6c757d}\n"
-    "        .value{font-size:2em;font-weight:700;color:#333}\n"
-    "        .alert-banner{display:none;width:100%;max-width:1000px;background-color:#dc3545;color:#fff;padding:10px;border-radius:8px;text-align:center;font-weight:700;margin-bottom:20px}\n"
-    "        .nav{margin-bottom:20px;font-size:1.2em}\n"
-    "    </style>\n"
-    "</head>\n"
-    "<body>\n"
-    "    <h1>Estação Meteorológica</h1>\n"
-    "    <div class=\"nav\"><a href=\"/settings\">Configurar Limites</a></div>\n"
-    "    <div id=\"alert_msg\" class=\"alert-banner\">ALERTA DE LIMITE!</div>\n"
-    "    <div class=\"container\">\n"
-    "        <div class=\"data-block\"><h2>Temperatura</h2><p class=\"value\"><span id=\"temp_val\">--</span>&deg;C</p><canvas id=\"tempChart\"></canvas></div>\n"
-    "        <div class=\"data-block\"><h2>Umidade</h2><p class=\"value\"><span id=\"umid_val\">--</span>%</p><canvas id=\"humidChart\"></canvas></div>\n"
-    "        <div class=\"data-block\"><h2>Pressão</h2><p class=\"value\"><span id=\"press_val\">--</span> hPa</p><canvas id=\"pressChart\"></canvas></div>\n"
-    "        <div class=\"data-block\"><h2>Altitude</h2><p class=\"value\"><span id=\"alt_val\">--</span> m</p><canvas id=\"altChart\"></canvas></div>\n"
-    "    </div>\n"
-    "    <script>\n"
-    "        const charts={};\n"
-    "        function createChart(e,a,t,l,r,n){const o=document.getElementById(e).getContext(\"2d\");charts[e]=new Chart(o,{type:\"line\",data:{labels:[],datasets:[{label:a,data:[],borderColor:t,tension:.2,fill:!0,backgroundColor:l}]},options:{scales:{y:{suggestedMin:r,suggestedMax:n}}}})}\n"
-    "        createChart(\"tempChart\",\"Temperatura (C)\",\"rgb(255,99,132)\",\"rgba(255,99,132,0.1)\",10,40);\n"
-    "        createChart(\"humidChart\",\"Umidade (%)\",\"rgb(54,162,235)\",\"rgba(54,162,235,0.1)\",0,100);\n"
-    "        createChart(\"pressChart\",\"Pressão (hPa)\",\"rgb(75,192,192)\",\"rgba(75,192,192,0.1)\",980,1030);\n"
-    "        createChart(\"altChart\",\"Altitude (m)\",\"rgb(255,159,64)\",\"rgba(255,159,64,0.1)\",-50,250);\n"
-    "        function fetchData(){fetch(\"/data\").then(e=>e.json()).then(e=>{document.getElementById(\"temp_val\").innerText=e.temp.toFixed(1);document.getElementById(\"umid_val\").innerText=e.hum.toFixed(1);document.getElementById(\"press_val\").innerText=e.press.toFixed(0);document.getElementById(\"alt_val\").innerText=e.alt.toFixed(0);document.getElementById(\"alert_msg\").style.display=e.alerta?\"block\":\"none\";const a=new Date,t=a.getHours()+\":\"+(\"0\"+a.getMinutes()).slice(-2)+\":\"+(\"0\"+a.getSeconds()).slice(-2);Object.values(charts).forEach(e=>{if(e.data.labels.length>15){e.data.labels.shift();e.data.datasets[0].data.shift()}e.data.labels.push(t)});charts.tempChart.data.datasets[0].data.push(e.temp);charts.humidChart.data.datasets[0].data.push(e.hum);charts.pressChart.data.datasets[0].data.push(e.press);charts.altChart.data.datasets[0].data.push(e.alt);Object.values(charts).forEach(e=>{e.update()})})}\n"
-    "        fetchData();setInterval(fetchData,2000);\n"
-    "    </script>\n"
-    "</body>\n"
-    "</html>\n";
-
-// string C contendo o código HTML para a página de configurações
-const char HTML_PAGE_SETTINGS_FORMAT[] =
-    "<!DOCTYPE html>\n"
-    "<html lang=\"pt-br\">\n"
-    "<head>\n"
-    "    <meta charset=\"UTF-8\">\n"
-    "    <meta name=\"viewport\" content=\"width=device-width,initial-scale=1\">\n"
-    "    <title>Configurações</title>\n"
-    "    <style>\n"
-    "        body{font-family:sans-serif;background-color:#f0f2f5;display:flex;flex-direction:column;align-items:center;padding:20px}\n"
-    "        h1{color:#333}\n"
-    "        form{background-color:#fff;padding:30px;border-radius:10px;box-shadow:0 4px 6px rgba(0,0,0,.1);width:100%%;max-width:500px}\n"
-    "        .form-group{margin-bottom:20px}\n"
-    "        label{display:block;margin-bottom:5px;font-weight:700;color:#555}\n"
-    "        input[type=number]{width:100%%;box-sizing:border-box;padding:10px;border:1px solid #ccc;border-radius:5px}\n"
-    "        input[type=submit]{background-color:#007bff;color:#fff;padding:12px 20px;border:none;border-radius:5px;cursor:pointer;font-size:1em;width:100%%}\n"
-    "        a{display:inline-block;margin-top:20px;color:#007bff}\n"
-    "    </style>\n"
-    "</head>\n"
-    "<body>\n"
-    "    <h1>Configurar Limites de Alerta</h1>\n"
-    "    <form action=\"/settings\" method=\"get\">\n"
-    "        <div class=\"form-group\"><label for=\"temp_min\">Temp. Mínima (°C):</label><input type=\"number\" id=\"temp_min\" name=\"temp_min\" step=\"0.1\" value=\"%.1f\"></div>\n"
-    "        <div class=\"form-group\"><label for=\"temp_max\">Temp. Máxima (°C):</label><input type=\"number\" id=\"temp_max\" name=\"temp_max\" step=\"0.1\" value=\"%.1f\"></div>\n"
-    "        <div class=\"form-group\"><label for=\"umid_min\">Umidade Mínima (%%):</label><input type=\"number\" id=\"umid_min\" name=\"umid_min\" step=\"1\" value=\"%.0f\"></div>\n"
-    "        <div class=\"form-group\"><label for=\"umid_max\">Umidade Máxima (%%):</label><input type=\"number\" id=\"umid_max\" name=\"umid_max\" step=\"1\" value=\"%.0f\"></div>\n"
-    "        <div class=\"form-group\"><label for=\"press_min\">Pressão Mínima (hPa):</label><input type=\"number\" id=\"press_min\" name=\"press_min\" step=\"1\" value=\"%.0f\"></div>\n"
-    "        <div class=\"form-group\"><label for=\"press_max\">Pressão Máxima (hPa):</label><input type=\"number\" id=\"press_max\" name=\"press_max\" step=\"1\" value=\"%.0f\"></div>\n"
-    "        <input type=\"submit\" value=\"Salvar Configurações\">\n"
-    "    </form>\n"
-    "    <a href=\"/\">Voltar à Página Principal</a>\n"
-    "</body>\n"
-    "</html>\n";
+bool display_pendente = false;   // quadro desenhado que ainda não pôde ser enviado ao display (DMA ocupado)
 
 // --- Funções Auxiliares de Periféricos ---
-// função para enviar um pixel para a matriz de LEDs WS2812 via PIO
-static inline void put_pixel(uint32_t pixel_grb) {
-    pio_sm_put_blocking(pio0, 0, pixel_grb << 8u);
-}
+// matriz de LEDs WS2812: framebuffer enviado por DMA ao PIO0 SM0 só quando muda
+static led_matrix_t matriz;
+#define BRILHO_MATRIZ 20                 // nível máximo de cada cor (de 255) depois da gama
+#define COR_NIVEL 0x0000A8               // azul fraco (~8 de saída com o brilho acima)
+#define COR_ALERTA 0xFF0000              // vermelho (20 de saída)
 
-// função para converter componentes R, G, B em um único valor de 32 bits
-static inline uint32_t urgb_u32(uint8_t r, uint8_t g, uint8_t b) {
-    return ((uint32_t)(r) << 8) | ((uint32_t)(g) << 16) | (uint32_t)(b);
-}
+// LED RGB e buzzer: padrões tocados por alarmes do timer, sem depender do loop principal
+static sequencer_t sinalizacao;
 
-// inicializa os pinos GPIO para o LED RGB
-void init_led_rgb() {
-    gpio_init(LED_R);                       // inicializa o pino do LED vermelho
-    gpio_set_dir(LED_R, GPIO_OUT);          // define o pino como saída
-    gpio_init(LED_G);                       // inicializa o pino do LED verde
-    gpio_set_dir(LED_G, GPIO_OUT);          // define o pino como saída
-    gpio_init(LED_B);                       // inicializa o pino do LED azul
-    gpio_set_dir(LED_B, GPIO_OUT);          // define o pino como saída
-}
-
-// acende o LED RGB em vermelho (alerta) ou verde (normal)
-void set_led_rgb(bool alerta) {
-    gpio_put(LED_R, alerta);                // acende o vermelho se houver alerta
-    gpio_put(LED_G, !alerta);               // acende o verde se não houver alerta
-    gpio_put(LED_B, 0);                     // mantém o azul desligado
-}
+// operação normal: verde fixo e buzzer mudo
+static const seq_step_t passos_normal[] = {
+    {0, 1000, SEQ_G},
+};
+// temperatura fora dos limites: dois bipes agudos curtos com o vermelho piscando
+static const seq_step_t passos_alerta_temp[] = {
+    {2000, 120, SEQ_R},
+    {0, 120, 0},
+    {2000, 120, SEQ_R},
+    {0, 640, 0},
+};
+// umidade fora dos limites: um bipe médio longo, LED magenta
+static const seq_step_t passos_alerta_umid[] = {
+    {1000, 400, SEQ_R | SEQ_B},
+    {0, 600, SEQ_B},
+};
+// pressão fora dos limites: três bipes graves, LED amarelo
+static const seq_step_t passos_alerta_press[] = {
+    {500, 100, SEQ_R | SEQ_G},
+    {0, 100, 0},
+    {500, 100, SEQ_R | SEQ_G},
+    {0, 100, 0},
+    {500, 100, SEQ_R | SEQ_G},
+    {0, 1000, 0},
+};
+static const seq_pattern_t padrao_normal = SEQ_PATTERN(passos_normal, 1);
+static const seq_pattern_t padrao_alerta_temp = SEQ_PATTERN(passos_alerta_temp, 0);
+static const seq_pattern_t padrao_alerta_umid = SEQ_PATTERN(passos_alerta_umid, 0);
+static const seq_pattern_t padrao_alerta_press = SEQ_PATTERN(passos_alerta_press, 0);
 
-// inicializa o pino do buzzer usando PWM para controle de volume
-void init_buzzer() {
-    gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM); // define a função do pino como PWM
-    uint slice_num = pwm_gpio_to_slice_num(BUZZER_PIN); // obtém a fatia de PWM correspondente ao pino
-    pwm_set_wrap(slice_num, 4095);          // define o valor máximo do contador de PWM (resolução)
-    pwm_set_clkdiv(slice_num, 250);         // define o divisor de clock para ajustar a frequência
-    pwm_set_enabled(slice_num, true);       // habilita o canal de PWM
-    pwm_set_gpio_level(BUZZER_PIN, 0);      // desliga o buzzer inicialmente
-}
+// padrão tocado por cada regra
+static const seq_pattern_t *const padroes_regras[NUM_REGRAS] = {
+    &padrao_alerta_temp, &padrao_alerta_temp, &padrao_alerta_umid, &padrao_alerta_umid,
+    &padrao_alerta_press, &padrao_alerta_press, &padrao_alerta_press,
+};
 
-// ativa ou desativa o buzzer com base no estado de alerta
-void set_buzzer(bool alerta) {
-    // define o nível do PWM para 50% do ciclo (2048) se houver alerta, ou 0% caso contrário
-    pwm_set_gpio_level(BUZZER_PIN, alerta ? 2048 : 0);
+// índice da primeira regra disparada (a de maior prioridade) ou -1 se nenhuma
+static int regra_principal(uint32_t ativas) {
+    for (int i = 0; i < NUM_REGRAS; i++) {
+        if (ativas & (1u << i)) return i;
+    }
+    return -1;
 }
 
 // atualiza a matriz de LEDs WS2812 para mostrar um indicador de nível
-void set_matriz_indicador(float valor, float min, float max) {
+void set_matriz_indicador(int32_t valor, int32_t min, int32_t max) {
     // calcula a porcentagem do valor atual em relação aos limites min e max
-    float percentual = 100.0 * (valor - min) / (max - min);
+    int32_t percentual = 100 * (valor - min) / (max - min);
     if (percentual < 0) percentual = 0;
     if (percentual > 100) percentual = 100;
 
     // converte a porcentagem em um número de linhas a serem acesas (0 a 5)
-    int linhas_acesas = (int)(percentual / 20.0f);
+    int linhas_acesas = (int)(percentual / 20);
     if (linhas_acesas < 0) linhas_acesas = 0;
     if (linhas_acesas > 5) linhas_acesas = 5;
 
-    uint32_t pixels[25] = {0};              // array para armazenar a cor de cada um dos 25 pixels
-    // mapa que corresponde ao índice do pixel físico na matriz
-    int pixel_map[5][5] = {
-        {24, 23, 22, 21, 20}, 
-        {15, 16, 17, 18, 19}, 
-        {14, 13, 12, 11, 10},
-        {5,  6,  7,  8,  9}, 
-        {4,  3,  2,  1,  0}
-    };
-
-    // acende as linhas correspondentes ao indicador de nível em azul
+    led_matrix_clear(&matriz);              // desenha o quadro do zero; o envio só ocorre se mudar
+    // acende as linhas correspondentes ao indicador de nível em azul, de baixo para cima
     for (int i = 4; i >= (4 - linhas_acesas + 1); i--) {
-        for (int j = 0; j < 5; j++) {
-            pixels[pixel_map[i][j]] = urgb_u32(0, 0, 8); // cor azul fraca
-        }
+        led_matrix_fill_row(&matriz, (uint8_t)i, COR_NIVEL);
     }
     // se o alerta estiver ativo, acende a primeira linha em vermelho
     if (alerta_ativo) {
-        for (int j = 0; j < 5; j++) {
-            pixels[pixel_map[0][j]] = urgb_u32(20, 0, 0); // cor vermelha
-        }
-    }
-    // envia as cores para todos os 25 pixels da matriz
-    for (int i = 0; i < 25; i++) {
-        put_pixel(pixels[i]);
+        led_matrix_fill_row(&matriz, 0, COR_ALERTA);
     }
+    uint64_t inicio = metrics_start();
+    led_matrix_show(&matriz);               // dispara o DMA (ou deixa pendente até o latch)
+    metrics_stop(&metrica_matriz, inicio);
 }
 
 // --- Funções de Display OLED e Interrupções ---
+// envia o quadro do display por DMA; só os envios que de fato começaram entram na métrica
+static bool enviar_display(ssd1306_t *ssd) {
+    uint64_t inicio = metrics_start();
+    if (!ssd1306_send_data_async(ssd)) return false;
+    metrics_stop(&metrica_display, inicio);
+    return true;
+}
+
 // desenha a tela do menu principal no display OLED
 void draw_menu_principal(ssd1306_t *ssd) {
     ssd1306_fill(ssd, false);               // limpa o buffer do display
@@ -230,32 +291,52 @@ void draw_menu_principal(ssd1306_t *ssd) {
 void draw_tela_monitoramento(ssd1306_t *ssd) {
     ssd1306_fill(ssd, false);               // limpa o buffer do display
     char buffer[20];                        // buffer temporário para formatar strings
+    size_t len;
 
     // usa um switch para decidir qual subtela mostrar com base na variável de estado
     switch (tela_monitor_sub_estado) {
         case 0: // Temperatura
             ssd1306_draw_string(ssd, "Temperatura:", 20, 4);
-            snprintf(buffer, sizeof(buffer), "%.1f C", temperatura_bmp);
+            len = fmt_fixed(buffer, sizeof(buffer), fmt_round(temperatura_bmp, 1), 1);
+            fmt_str(buffer + len, sizeof(buffer) - len, " C");
             ssd1306_draw_string(ssd, buffer, 38, 20);
             break;
         case 1: // Umidade
             ssd1306_draw_string(ssd, "Umidade:", 32, 4);
-            snprintf(buffer, sizeof(buffer), "%.1f%%", umidade_aht);
+            len = fmt_fixed(buffer, sizeof(buffer), fmt_round(umidade_aht, 1), 1);
+            fmt_str(buffer + len, sizeof(buffer) - len, "%");
             ssd1306_draw_string(ssd, buffer, 38, 20);
             break;
         case 2: // Pressão
             ssd1306_draw_string(ssd, "Pressao:", 32, 4);
-            snprintf(buffer, sizeof(buffer), "%.0f hPa", pressao_bmp);
+            len = fmt_int(buffer, sizeof(buffer), fmt_round(pressao_bmp, 2));
+            fmt_str(buffer + len, sizeof(buffer) - len, " hPa");
             ssd1306_draw_string(ssd, buffer, 30, 20);
             break;
         case 3: // Altitude
             ssd1306_draw_string(ssd, "Altitude:", 28, 4);
-            snprintf(buffer, sizeof(buffer), "%.0fm", altitude_bmp);
+            len = fmt_int(buffer, sizeof(buffer), fmt_round(altitude_bmp, 2));
+            fmt_str(buffer + len, sizeof(buffer) - len, "m");
             ssd1306_draw_string(ssd, buffer, 42, 20);
             break;
     }
-    // exibe o status de alerta em todas as subtelas de monitoramento
-    ssd1306_draw_string(ssd, alerta_ativo ? "ALERTA!" : "Normal", 38, 52);
+    // exibe o status de alerta em todas as subtelas de monitoramento: a regra de maior prioridade disparada
+    int regra = regra_principal(alerts_active_mask(&alertas));
+    const char *status = regra < 0 ? "Normal" : rotulos_regras[regra];
+    ssd1306_draw_string(ssd, status, (uint8_t)((128 - 8 * (int)strlen(status)) / 2), 52);
+}
+
+// escreve "<rotulo><valor><unidade>" para as telas de limites; valor em centésimos da
+// unidade (°C, %, hPa), mostrado com "casas" casas decimais
+static void formatar_limite(char *dst, size_t cap, const char *rotulo, int32_t valor, unsigned casas, const char *unidade) {
+    size_t len = fmt_str(dst, cap, rotulo);
+    len += fmt_fixed(dst + len, cap - len, fmt_round(valor, 2 - casas), casas);
+    fmt_str(dst + len, cap - len, unidade);
+}
+
+// limite atual de uma regra no motor do núcleo de aquisição
+static int32_t limite_regra(int regra) {
+    return alertas.rules[regra].config.threshold;
 }
 
 // desenha as telas de limites e IP no display OLED
@@ -268,23 +349,23 @@ void draw_tela_limites(ssd1306_t *ssd) {
     switch (tela_limites_sub_estado) {
         case 0: // Limites de Temperatura
             ssd1306_draw_string(ssd, "Limites Temp:", 4, 4);
-            snprintf(buffer, sizeof(buffer), "Min: %.1f C", temp_lim_min);
+            formatar_limite(buffer, sizeof(buffer), "Min: ", limite_regra(REGRA_TEMP_MIN), 1, " C");
             ssd1306_draw_string(ssd, buffer, 4, 28);
-            snprintf(buffer2, sizeof(buffer2), "Max: %.1f C", temp_lim_max);
+            formatar_limite(buffer2, sizeof(buffer2), "Max: ", limite_regra(REGRA_TEMP_MAX), 1, " C");
             ssd1306_draw_string(ssd, buffer2, 4, 44);
             break;
         case 1: // Limites de Umidade
             ssd1306_draw_string(ssd, "Limites Umid:", 4, 4);
-            snprintf(buffer, sizeof(buffer), "Min: %.0f%%", umid_lim_min);
+            formatar_limite(buffer, sizeof(buffer), "Min: ", limite_regra(REGRA_UMID_MIN), 0, "%");
             ssd1306_draw_string(ssd, buffer, 4, 28);
-            snprintf(buffer2, sizeof(buffer2), "Max: %.0f%%", umid_lim_max);
+            formatar_limite(buffer2, sizeof(buffer2), "Max: ", limite_regra(REGRA_UMID_MAX), 0, "%");
             ssd1306_draw_string(ssd, buffer2, 4, 44);
             break;
         case 2: // Limites de Pressão
             ssd1306_draw_string(ssd, "Limites Press:", 4, 4);
-            snprintf(buffer, sizeof(buffer), "Min: %.0f hPa", press_lim_min);
+            formatar_limite(buffer, sizeof(buffer), "Min: ", limite_regra(REGRA_PRESS_MIN), 0, " hPa");
             ssd1306_draw_string(ssd, buffer, 4, 28);
-            snprintf(buffer2, sizeof(buffer2), "Max: %.0f hPa", press_lim_max);
+            formatar_limite(buffer2, sizeof(buffer2), "Max: ", limite_regra(REGRA_PRESS_MAX), 0, " hPa");
             ssd1306_draw_string(ssd, buffer2, 4, 44);
             break;
         case 3: // IP de Conexão
@@ -307,7 +388,8 @@ void update_display(ssd1306_t *ssd) {
             draw_tela_limites(ssd);
             break;
     }
-    ssd1306_send_data(ssd); // envia o conteúdo do buffer para o hardware do display
+    // envia o buffer por DMA; se o quadro anterior ainda está no barramento, tenta de novo no loop
+    display_pendente = !enviar_display(ssd);
 }
 
 // função de callback para tratar interrupções dos botões
@@ -337,130 +419,653 @@ void gpio_irq_handler(uint gpio, uint32_t events) {
 }
 
 // --- LÓGICA DO WEBSERVER ---
-// estrutura para manter o estado da resposta HTTP
-struct http_state { char response[4096]; size_t len; size_t sent; };
-
-// callback chamado quando os dados TCP são enviados com sucesso
-static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-    struct http_state *hs = (struct http_state *)arg;
-    hs->sent += len;
-    if (hs->sent >= hs->len) {
-        tcp_close(tpcb);                      // fecha a conexão TCP
-        free(hs);                             // libera a memória da estrutura de estado
-    }
-    return ERR_OK;
-}
-
-// função para analisar a URL da requisição e atualizar os valores de limite
-void parse_and_update_value(const char* request, const char* key, float* value) {
-    char* key_ptr = strstr(request, key);     // procura a chave (ex: "temp_min=") na string da requisição
-    if (key_ptr) {
-        float new_val = atof(key_ptr + strlen(key)); // converte o número após a chave para float
-        *value = new_val;                     // atualiza a variável global correspondente
-    }
-}
-
-// callback chamado quando dados TCP são recebidos (uma requisição HTTP)
-static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    if (!p) {
-        tcp_close(tpcb);
-        return ERR_OK;
-    }
-    char *req = (char *)p->payload;           // ponteiro para os dados da requisição
-    struct http_state *hs = malloc(sizeof(struct http_state));
-    hs->sent = 0;
-
-    // Roteamento: decide o que fazer com base na URL da requisição
-    if (strncmp(req, "GET /data", 9) == 0) { // se a requisição é para /data
-        char json_payload[256];
-        // cria uma string JSON com os dados atuais dos sensores
-        int json_len = snprintf(json_payload, sizeof(json_payload),
-                                "{\"temp\":%.2f, \"hum\":%.2f, \"press\":%.2f, \"alt\":%.2f, \"alerta\":%s}",
-                                temperatura_bmp, umidade_aht, pressao_bmp, altitude_bmp, alerta_ativo ? "true" : "false");
-
-        // monta a resposta HTTP com o cabeçalho de JSON
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                           "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n%s",
-                           json_len, json_payload);
-
-    } else if (strncmp(req, "GET /settings", 13) == 0) { // se a requisição é para /settings
-        if (strstr(req, "?")) {               // se a URL contém '?', indica um envio de formulário
-            // chama a função de parse para cada um dos 6 limites
-            parse_and_update_value(req, "temp_min=", &temp_lim_min);
-            parse_and_update_value(req, "temp_max=", &temp_lim_max);
-            parse_and_update_value(req, "umid_min=", &umid_lim_min);
-            parse_and_update_value(req, "umid_max=", &umid_lim_max);
-            parse_and_update_value(req, "press_min=", &press_lim_min);
-            parse_and_update_value(req, "press_max=", &press_lim_max);
-            printf("Limites atualizados via web!\n");
-            
-            // envia uma resposta de redirecionamento para o navegador voltar à página principal
-            hs->len = snprintf(hs->response, sizeof(hs->response), "HTTP/1.1 302 Found\r\nLocation: /\r\n\r\n");
-        } else {                              // se não tem '?', apenas exibe a página de configurações
-            char* page_buffer = hs->response + 1024; // usa um buffer temporário para a página
-            // monta a página de configurações, inserindo os valores atuais nos campos do formulário
-            int page_len = snprintf(page_buffer, sizeof(hs->response) - 1024, HTML_PAGE_SETTINGS_FORMAT,
-                                    temp_lim_min, temp_lim_max, umid_lim_min, umid_lim_max, press_lim_min, press_lim_max);
-
-            // monta a resposta HTTP com o cabeçalho de HTML
-            hs->len = snprintf(hs->response, sizeof(hs->response),
-                               "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: %d\r\n\r\n%s",
-                               page_len, page_buffer);
+// limita um valor já escalado à faixa de um campo de 16 bits do histórico ou dos quadros WebSocket
+static int32_t limitar(int32_t valor, int32_t min, int32_t max) {
+    return valor < min ? min : (valor > max ? max : valor);
+}
+
+// primeiro registro a enviar: o posterior a "since", ou os "recentes" mais novos sem o parâmetro
+static uint32_t inicio_historico(const httpd_request_t *req, uint32_t recentes) {
+    uint32_t primeiro = history_first_seq(&historico);
+    uint32_t proximo = history_next_seq(&historico);
+    const char *since = httpd_param(req, "since");
+    if (!since) return proximo - primeiro > recentes ? proximo - recentes : primeiro;
+    uint32_t inicio = (uint32_t)strtoul(since, NULL, 10) + 1;
+    if (inicio < primeiro) inicio = primeiro;
+    if (inicio > proximo) inicio = proximo;      // since de um boot anterior: ressincroniza o cliente
+    return inicio;
+}
+
+static int montar_json_historico(const httpd_request_t *req, char *buf, size_t cap) {
+    uint32_t primeiro = history_first_seq(&historico);
+    uint32_t proximo = history_next_seq(&historico);
+    uint32_t inicio = inicio_historico(req, HISTORICO_MAX_POR_RESPOSTA);
+
+    int len = snprintf(buf, cap, "{\"now\":%lu,\"period\":%d,\"first\":%lu,\"samples\":[",
+                       (unsigned long)to_ms_since_boot(get_absolute_time()), PERIODO_HISTORICO_MS,
+                       (unsigned long)primeiro);
+    uint32_t seq = inicio;
+    history_record_t reg;
+    // cada linha ocupa no máximo ~60 bytes; reserva espaço para o fechamento do JSON
+    for (; seq < proximo && seq - inicio < HISTORICO_MAX_POR_RESPOSTA && (size_t)len + 96 < cap; seq++) {
+        if (!history_get(&historico, seq, &reg)) continue;
+        len += snprintf(buf + len, cap - len, "%s[%lu,%lu,", seq == inicio ? "" : ",",
+                        (unsigned long)seq, (unsigned long)reg.timestamp_ms);
+        len += fmt_fixed(buf + len, cap - len, reg.temp_c100, 2);
+        buf[len++] = ',';
+        len += fmt_fixed(buf + len, cap - len, reg.umid_c100, 2);
+        buf[len++] = ',';
+        len += fmt_fixed(buf + len, cap - len, (int32_t)reg.press_off_pa + HISTORY_PRESS_OFFSET_PA, 2);
+        buf[len++] = ',';
+        len += fmt_fixed(buf + len, cap - len, reg.alt_dm, 1);
+        buf[len++] = ']';
+    }
+    // "next" é o valor de since para a próxima consulta; "more" indica que ainda há registros
+    len += snprintf(buf + len, cap - len, "],\"next\":%lu,\"more\":%s}",
+                    (unsigned long)(seq - 1), seq < proximo ? "true" : "false");
+    return len;
+}
+
+// Formato binário de /data (versão DADOS_BINARIO_VERSAO), little-endian:
+//   cabeçalho, 20 bytes: [0] versão, [1] tamanho de cada registro (12), [2..3] uint16
+//     quantidade de registros, [4..7] uint32 sequência do primeiro registro, [8..11]
+//     uint32 valor de since para a próxima consulta, [12..15] uint32 instante atual (ms
+//     desde o boot), [16..17] uint16 período entre registros (ms), [18] flags (bit 0:
+//     ainda há registros), [19] reservado
+//   registros consecutivos a partir do primeiro, 12 bytes cada: [0..3] uint32 instante
+//     (ms), [4..5] int16 temperatura (centésimos de °C), [6..7] uint16 umidade
+//     (centésimos de %), [8..9] uint16 pressão (Pa - HISTORY_PRESS_OFFSET_PA), [10..11]
+//     int16 altitude (dm)
+// Uma mudança incompatível no layout incrementa a versão.
+#define DADOS_BINARIO_VERSAO 1
+#define DADOS_BINARIO_CABECALHO 20
+#define DADOS_BINARIO_REGISTRO 12
+#define DADOS_BINARIO_MAX 240                        // registros por resposta (8 min de histórico)
+
+static void escrever_le(uint8_t *dst, uint32_t valor, int bytes) {
+    for (int i = 0; i < bytes; i++) dst[i] = (uint8_t)(valor >> (8 * i));
+}
+
+// monta a resposta binária de /data: registros posteriores a "since" (sem o parâmetro,
+// apenas o mais recente), limitados a DADOS_BINARIO_MAX e ao tamanho de buf
+static int montar_binario_dados(const httpd_request_t *req, uint8_t *buf, size_t cap) {
+    uint32_t proximo = history_next_seq(&historico);
+    uint32_t inicio = inicio_historico(req, 1);
+    uint32_t max = (uint32_t)((cap - DADOS_BINARIO_CABECALHO) / DADOS_BINARIO_REGISTRO);
+    if (max > DADOS_BINARIO_MAX) max = DADOS_BINARIO_MAX;
+
+    uint32_t seq = inicio;
+    uint8_t *reg_buf = buf + DADOS_BINARIO_CABECALHO;
+    history_record_t reg;
+    for (; seq < proximo && seq - inicio < max && history_get(&historico, seq, &reg); seq++) {
+        escrever_le(reg_buf, reg.timestamp_ms, 4);
+        escrever_le(reg_buf + 4, (uint16_t)reg.temp_c100, 2);
+        escrever_le(reg_buf + 6, reg.umid_c100, 2);
+        escrever_le(reg_buf + 8, reg.press_off_pa, 2);
+        escrever_le(reg_buf + 10, (uint16_t)reg.alt_dm, 2);
+        reg_buf += DADOS_BINARIO_REGISTRO;
+    }
+    buf[0] = DADOS_BINARIO_VERSAO;
+    buf[1] = DADOS_BINARIO_REGISTRO;
+    escrever_le(buf + 2, seq - inicio, 2);
+    escrever_le(buf + 4, inicio, 4);
+    escrever_le(buf + 8, seq - 1, 4);
+    escrever_le(buf + 12, to_ms_since_boot(get_absolute_time()), 4);
+    escrever_le(buf + 16, PERIODO_HISTORICO_MS, 2);
+    buf[18] = seq < proximo ? 1 : 0;
+    buf[19] = 0;
+    return (int)(reg_buf - buf);
+}
+
+// lê um parâmetro numérico da query; retorna padrao se ausente
+static uint32_t parametro_numerico(const httpd_request_t *req, const char *chave, uint32_t padrao) {
+    const char *valor = httpd_param(req, chave);
+    return valor ? (uint32_t)strtoul(valor, NULL, 10) : padrao;
+}
+
+// escreve mínimo, máximo e média de cada canal de um balde
+static int formatar_balde(char *dst, size_t cap, const rollup_bucket_t *b) {
+    static const int casas[ROLLUP_CHANNELS] = { 2, 2, 2, 1 };
+    int len = snprintf(dst, cap, "[%lu,%lu", (unsigned long)b->start_s, (unsigned long)b->count);
+    for (uint32_t c = 0; c < ROLLUP_CHANNELS; c++) {
+        dst[len++] = ',';
+        len += fmt_fixed(dst + len, cap - len, b->min[c], casas[c]);
+        dst[len++] = ',';
+        len += fmt_fixed(dst + len, cap - len, b->max[c], casas[c]);
+        dst[len++] = ',';
+        len += fmt_fixed(dst + len, cap - len, rollup_bucket_avg(b, c), casas[c]);
+    }
+    dst[len++] = ']';
+    return len;
+}
+
+// monta o JSON de /rollup?window=<s>&points=<n>: a camada mais fina (histórico bruto,
+// minuto ou hora) que cobre a janela com até "points" baldes
+static int montar_json_agregados(const httpd_request_t *req, char *buf, size_t cap) {
+    uint32_t janela = parametro_numerico(req, "window", 86400);
+    uint32_t pontos = parametro_numerico(req, "points", AGREGADOS_MAX_POR_RESPOSTA);
+    if (pontos == 0 || pontos > AGREGADOS_MAX_POR_RESPOSTA) pontos = AGREGADOS_MAX_POR_RESPOSTA;
+    if (janela == 0) janela = 1;
+    // nenhuma camada cobre mais que a mais grossa; limitar aqui também evita
+    // que janela * 1000 estoure os 32 bits
+    const rollup_tier_t *grossa = &agregados.tiers[agregados.num_tiers - 1];
+    if (janela > grossa->resolution_s * grossa->capacity) janela = grossa->resolution_s * grossa->capacity;
+
+    int len = snprintf(buf, cap, "{\"now\":%lu,", (unsigned long)to_ms_since_boot(get_absolute_time()));
+    uint32_t n = 0;
+    rollup_bucket_t balde;
+
+    uint32_t brutos = (janela * 1000 + PERIODO_HISTORICO_MS - 1) / PERIODO_HISTORICO_MS;
+    if (brutos <= pontos && brutos <= TAMANHO_HISTORICO) {
+        // janela curta: o próprio histórico, um registro por balde
+        uint32_t proximo = history_next_seq(&historico);
+        uint32_t seq = proximo - history_first_seq(&historico) > brutos ? proximo - brutos : history_first_seq(&historico);
+        len += snprintf(buf + len, cap - len, "\"res\":%d,\"buckets\":[", PERIODO_HISTORICO_MS / 1000);
+        history_record_t reg;
+        for (; seq < proximo; seq++) {
+            if (!history_get(&historico, seq, &reg)) continue;
+            balde.start_s = reg.timestamp_ms / 1000;
+            balde.count = 1;
+            int32_t v[ROLLUP_CHANNELS] = { reg.temp_c100, reg.umid_c100, (int32_t)reg.press_off_pa + HISTORY_PRESS_OFFSET_PA, reg.alt_dm };
+            for (uint32_t c = 0; c < ROLLUP_CHANNELS; c++) balde.min[c] = balde.max[c] = balde.sum[c] = v[c];
+            if (n++) buf[len++] = ',';
+            len += formatar_balde(buf + len, cap - len, &balde);
+        }
+    } else {
+        const rollup_tier_t *camada = rollup_select(&agregados, janela, pontos);
+        uint32_t total = rollup_tier_size(camada);
+        uint32_t quantos = (janela + camada->resolution_s - 1) / camada->resolution_s;
+        if (quantos > pontos) quantos = pontos;
+        uint32_t i = total > quantos ? total - quantos : 0;
+        len += snprintf(buf + len, cap - len, "\"res\":%lu,\"buckets\":[", (unsigned long)camada->resolution_s);
+        for (; i < total && rollup_tier_get(camada, i, &balde); i++) {
+            if (n++) buf[len++] = ',';
+            len += formatar_balde(buf + len, cap - len, &balde);
         }
-    } else { // para qualquer outra requisição (ex: "/"), serve a página principal
-        hs->len = snprintf(hs->response, sizeof(hs->response),
-                           "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: %d\r\n\r\n%s",
-                           (int)strlen(HTML_PAGE), HTML_PAGE);
     }
+    len += snprintf(buf + len, cap - len, "]}");
+    return len;
+}
+
+// monta o JSON de /log?page=<seq>: uma página do registro na flash (a mais recente
+// se o parâmetro não for informado); os instantes são relativos ao boot indicado
+static int montar_json_registro(const httpd_request_t *req, char *buf, size_t cap) {
+    uint32_t primeira = flashlog_first_seq(&registro_flash);
+    uint32_t proxima = flashlog_next_seq(&registro_flash);
+    uint32_t seq = parametro_numerico(req, "page", proxima ? proxima - 1 : 0);
+    const flashlog_page_t *pagina = flashlog_page(&registro_flash, seq);
+
+    int len = snprintf(buf, cap, "{\"boot\":%u,\"first\":%lu,\"next\":%lu,\"page\":%lu",
+                       registro_flash.boot, (unsigned long)primeira, (unsigned long)proxima, (unsigned long)seq);
+    if (!pagina) {
+        return len + snprintf(buf + len, cap - len, ",\"samples\":null}");
+    }
+    len += snprintf(buf + len, cap - len, ",\"page_boot\":%u,\"samples\":[", pagina->boot);
+    for (uint32_t i = 0; i < registro_flash.records_per_page; i++) {
+        history_record_t reg;
+        memcpy(&reg, pagina->payload + i * sizeof(reg), sizeof(reg));
+        len += snprintf(buf + len, cap - len, "%s[%lu,", i ? "," : "", (unsigned long)reg.timestamp_ms);
+        len += fmt_fixed(buf + len, cap - len, reg.temp_c100, 2);
+        buf[len++] = ',';
+        len += fmt_fixed(buf + len, cap - len, reg.umid_c100, 2);
+        buf[len++] = ',';
+        len += fmt_fixed(buf + len, cap - len, (int32_t)reg.press_off_pa + HISTORY_PRESS_OFFSET_PA, 2);
+        buf[len++] = ',';
+        len += fmt_fixed(buf + len, cap - len, reg.alt_dm, 1);
+        buf[len++] = ']';
+    }
+    return len + snprintf(buf + len, cap - len, "]}");
+}
+
+// prepara a resposta de uma página embutida: 304 se o cliente já tem esta versão (ETag),
+// senão a página comprimida (ou a original, se o cliente não aceita gzip) direto da flash
+static void servir_pagina(httpd_response_t *resp, const httpd_request_t *req, const web_asset_t *pagina) {
+    bool gzip = httpd_has_token(httpd_request_header(req, HTTPD_H_ACCEPT_ENCODING), "gzip");
+    const char *etags = httpd_request_header(req, HTTPD_H_IF_NONE_MATCH);
+    // cada codificação tem sua própria ETag; ambas revalidam pelo mesmo hash
+    char etag_gz[48];
+    snprintf(etag_gz, sizeof(etag_gz), "%s-gz", pagina->etag);
+    if (httpd_etag_match(etags, pagina->etag) || httpd_etag_match(etags, etag_gz)) {
+        httpd_status(resp, 304);
+    } else {
+        httpd_header(resp, "Content-Type: %s", pagina->content_type);
+        if (gzip) httpd_header(resp, "Content-Encoding: gzip");
+        httpd_static_body(resp, gzip ? pagina->gz : pagina->data, gzip ? pagina->gz_len : pagina->len);
+    }
+    httpd_header(resp, "Vary: Accept-Encoding");
+    httpd_header(resp, "ETag: \"%s%s\"", pagina->etag, gzip ? "-gz" : "");
+    httpd_header(resp, "Cache-Control: no-cache");
+}
 
-    tcp_arg(tpcb, hs);
-    tcp_sent(tpcb, http_sent);                // define a função de callback para quando os dados são enviados
-    tcp_write(tpcb, hs->response, hs->len, TCP_WRITE_FLAG_COPY); // enfileira a resposta para ser enviada
-    tcp_output(tpcb);                         // envia os dados enfileirados
-    pbuf_free(p);                             // libera o buffer da requisição
-    return ERR_OK;
+// escreve o JSON de uma amostra, usado por /data e pelos eventos de /events
+static int formatar_json_amostra(char *dst, size_t cap, const amostra_t *amostra) {
+    size_t len = fmt_str(dst, cap, "{\"temp\":");
+    len += fmt_fixed(dst + len, cap - len, amostra->temp_c100, 2);
+    len += fmt_str(dst + len, cap - len, ", \"hum\":");
+    len += fmt_fixed(dst + len, cap - len, amostra->umid_c100, 2);
+    len += fmt_str(dst + len, cap - len, ", \"press\":");
+    len += fmt_fixed(dst + len, cap - len, amostra->press_pa, 2);      // Pa = centésimos de hPa
+    len += fmt_str(dst + len, cap - len, ", \"alt\":");
+    len += fmt_fixed(dst + len, cap - len, amostra->alt_cm, 2);
+    len += fmt_str(dst + len, cap - len, ", \"regras\":");
+    len += fmt_uint(dst + len, cap - len, amostra->regras_ativas);
+    len += fmt_str(dst + len, cap - len, amostra->alerta ? ", \"alerta\":true}" : ", \"alerta\":false}");
+    return (int)len;
 }
 
-// callback chamado quando uma nova conexão TCP é estabelecida
-static err_t connection_callback(void *arg, struct tcp_pcb *newpcb, err_t err) {
-    tcp_recv(newpcb, http_recv);              // define a função de callback para quando dados são recebidos
-    return ERR_OK;
+// rota /data: JSON com os dados atuais dos sensores ou, negociado por "Accept:
+// application/octet-stream" (ou ?format=bin), o lote binário de registros desde "since"
+static void rota_dados(const httpd_request_t *req, httpd_response_t *resp) {
+    const char *formato = httpd_param(req, "format");
+    httpd_header(resp, "Vary: Accept");
+    if (formato ? strcmp(formato, "bin") == 0
+                : httpd_has_token(httpd_request_header(req, HTTPD_H_ACCEPT), "application/octet-stream")) {
+        httpd_header(resp, "Content-Type: application/octet-stream");
+        httpd_header(resp, "X-Schema-Version: %d", DADOS_BINARIO_VERSAO);
+        resp->body_len = montar_binario_dados(req, (uint8_t *)resp->body, sizeof(resp->body));
+    } else if (httpd_param(req, "since")) {
+        // lote em JSON: o mesmo formato de /history
+        httpd_header(resp, "Content-Type: application/json");
+        resp->body_len = montar_json_historico(req, resp->body, sizeof(resp->body));
+    } else {
+        httpd_header(resp, "Content-Type: application/json");
+        resp->body_len = formatar_json_amostra(resp->body, sizeof(resp->body), &ultima_amostra);
+    }
 }
 
-// inicializa e inicia o servidor HTTP na porta 80
-static void start_http_server(void) {
-    struct tcp_pcb *pcb = tcp_new();
-    if (!pcb || tcp_bind(pcb, IP_ADDR_ANY, 80) != ERR_OK) {
+// rota /events: fluxo text/event-stream com um evento "amostra" a cada nova leitura e
+// um evento "alerta" a cada mudança do estado de alerta (enviados por publicar_amostra)
+static void rota_eventos(const httpd_request_t *req, httpd_response_t *resp) {
+    (void)req;
+    if (!httpd_stream(resp)) {                 // fluxos esgotados: o cliente tenta de novo depois
+        httpd_status(resp, 503);
+        httpd_header(resp, "Retry-After: 5");
         return;
     }
-    pcb = tcp_listen(pcb);
-    tcp_accept(pcb, connection_callback);     // define a função de callback para novas conexões
+    httpd_header(resp, "Content-Type: text/event-stream");
+    httpd_header(resp, "Cache-Control: no-cache");
+    // intervalo de reconexão do EventSource e a amostra atual, para a página não esperar a próxima
+    int len = snprintf(resp->body, sizeof(resp->body), "retry: 2000\n\nevent: amostra\ndata: ");
+    len += formatar_json_amostra(resp->body + len, sizeof(resp->body) - len, &ultima_amostra);
+    len += snprintf(resp->body + len, sizeof(resp->body) - len, "\n\n");
+    resp->body_len = len;
 }
 
-// --- Função Principal (main) ---
-int main() {                                  // ponto de entrada do programa
-    stdio_init_all();                         // inicializa a comunicação serial para o printf
-    sleep_ms(2000);                           // aguarda 2 segundos para estabilizar
-    printf("Iniciando Estacao Meteorologica ...\n");
+// --- WEBSOCKET (/ws) ---
+// Quadros binários, little-endian:
+//   0x01 amostra (servidor -> cliente, a cada leitura), 16 bytes:
+//        [0] tipo, [1] flags (bit 0: alerta), [2..3] int16 temperatura (centésimos de °C),
+//        [4..5] uint16 umidade (centésimos de %), [6..9] uint32 pressão (Pa),
+//        [10..11] int16 altitude (dm), [12..15] uint32 instante (ms desde o boot)
+//   0x02 limites (nos dois sentidos), 25 bytes: [0] tipo e seis float32 na ordem
+//        temp_min, temp_max, umid_min, umid_max (°C e %), press_min, press_max (hPa).
+//        Recebido de um cliente, é aplicado e reenviado a todos os clientes como confirmação
+#define WS_AMOSTRA 0x01
+#define WS_LIMITES 0x02
+#define WS_TAMANHO_AMOSTRA 16
+#define WS_TAMANHO_LIMITES 25
 
-    // inicializa o módulo Wi-Fi
-    if (cyw43_arch_init()) {
-        printf("Falha ao inicializar o modulo Wi-Fi\n");
-        return 1;
+// regras dos limites (centésimos de °C, de % e de hPa), na ordem do quadro WS_LIMITES
+static const uint8_t limites_ws[6] = {
+    REGRA_TEMP_MIN, REGRA_TEMP_MAX, REGRA_UMID_MIN, REGRA_UMID_MAX, REGRA_PRESS_MIN, REGRA_PRESS_MAX,
+};
+
+// índice de um nome numa tabela de nomes, ou -1
+static int buscar_nome(const char *const *nomes, int total, const char *nome) {
+    for (int i = 0; i < total; i++) {
+        if (strcmp(nomes[i], nome) == 0) return i;
     }
-    cyw43_arch_enable_sta_mode();             // habilita o modo "station" (cliente Wi-Fi)
-    printf("Conectando ao Wi-Fi...\n");
-    // tenta conectar à rede Wi-Fi com um timeout de 30 segundos
-    if (cyw43_arch_wifi_connect_timeout_ms("Apartamento 01", "12345678", CYW43_AUTH_WPA2_AES_PSK, 30000)) {
-        printf("Falha na conexao Wi-Fi\n");
-    } else {
-        printf("Conectado ao Wi-Fi\n");
-        // obtém e exibe o endereço IP
-        uint8_t *ip = (uint8_t *)&(cyw43_state.netif[0].ip_addr.addr);
-        snprintf(ip_str, sizeof(ip_str), "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
-        printf("IP: %s\n", ip_str);
+    return -1;
+}
+
+static int buscar_regra(const char *nome) {
+    return buscar_nome(nomes_regras, NUM_REGRAS, nome);
+}
+
+// vagas numa fila para o núcleo 1; como só o consumidor a esvazia, o produtor pode
+// contar com elas até o próximo push
+static uint32_t vagas_fila(spsc_ring_t *fila) {
+    return fila->capacity - spsc_ring_count(fila);
+}
+
+// o núcleo 1 ainda não consumiu as edições anteriores: o cliente tenta de novo depois
+static void responder_fila_cheia(httpd_response_t *resp) {
+    httpd_status(resp, 503);
+    httpd_header(resp, "Retry-After: 1");
+}
+
+// envia uma configuração de regra ao motor de regras e, só se ela entrou na fila,
+// aplica na cópia do servidor web
+static bool editar_regra(uint32_t indice, const alert_rule_config_t *config) {
+    edicao_regra_t edicao = { indice, *config };
+    if (!spsc_ring_push(&fila_regras, &edicao)) {
+        printf("Fila de edicoes de regras cheia!\n");
+        return false;
     }
-    
+    regras_config[indice] = *config;
+    return true;
+}
+
+// troca só o limite de uma regra
+static bool editar_limite(uint32_t indice, int32_t limite) {
+    alert_rule_config_t config = regras_config[indice];
+    config.threshold = limite;
+    return editar_regra(indice, &config);
+}
+
+static void montar_quadro_amostra(uint8_t *quadro, const amostra_t *amostra) {
+    quadro[0] = WS_AMOSTRA;
+    quadro[1] = amostra->alerta ? 1 : 0;
+    escrever_le(quadro + 2, (uint32_t)limitar(amostra->temp_c100, INT16_MIN, INT16_MAX), 2);
+    escrever_le(quadro + 4, (uint32_t)limitar(amostra->umid_c100, 0, UINT16_MAX), 2);
+    escrever_le(quadro + 6, (uint32_t)amostra->press_pa, 4);
+    escrever_le(quadro + 10, (uint32_t)limitar(fmt_round(amostra->alt_cm, 1), INT16_MIN, INT16_MAX), 2);
+    escrever_le(quadro + 12, (uint32_t)(amostra->timestamp_us / 1000), 4);
+}
+
+static void montar_quadro_limites(uint8_t *quadro) {
+    quadro[0] = WS_LIMITES;
+    for (int i = 0; i < 6; i++) {
+        float valor = regras_config[limites_ws[i]].threshold / 100.0f;
+        uint32_t bits;
+        memcpy(&bits, &valor, sizeof(bits));
+        escrever_le(quadro + 1 + 4 * i, bits, 4);
+    }
+}
+
+// mensagem recebida de um cliente WebSocket: só quadros de limites são aceitos
+static void mensagem_websocket(int id, const uint8_t *dados, size_t len, bool binario) {
+    (void)id;
+    if (!binario || len != WS_TAMANHO_LIMITES || dados[0] != WS_LIMITES) return;
+    // o quadro é aplicado inteiro ou descartado; os limites atuais voltam ao cliente de todo jeito
+    bool cabe = vagas_fila(&fila_regras) >= 6;
+    for (int i = 0; cabe && i < 6; i++) {
+        uint32_t bits = 0;
+        for (int b = 3; b >= 0; b--) bits = bits << 8 | dados[1 + 4 * i + b];
+        float valor;
+        memcpy(&valor, &bits, sizeof(valor));
+        if (isfinite(valor)) editar_limite(limites_ws[i], fmt_scale(valor, 2));
+    }
+    printf(cabe ? "Limites atualizados via WebSocket!\n" : "Limites via WebSocket descartados: fila cheia\n");
+
+    uint8_t quadro[WS_TAMANHO_LIMITES];
+    montar_quadro_limites(quadro);
+    httpd_ws_broadcast(quadro, sizeof(quadro), true);
+}
+
+// rota /ws: upgrade para WebSocket (a resposta de erro já vem preenchida se recusado)
+static void rota_websocket(const httpd_request_t *req, httpd_response_t *resp) {
+    httpd_websocket(req, resp, mensagem_websocket);
+}
+
+// rota /history?since=<seq>
+static void rota_historico(const httpd_request_t *req, httpd_response_t *resp) {
+    httpd_header(resp, "Content-Type: application/json");
+    resp->body_len = montar_json_historico(req, resp->body, sizeof(resp->body));
+}
+
+// rota /rollup?window=<s>&points=<n>
+static void rota_agregados(const httpd_request_t *req, httpd_response_t *resp) {
+    httpd_header(resp, "Content-Type: application/json");
+    resp->body_len = montar_json_agregados(req, resp->body, sizeof(resp->body));
+}
+
+// rota /log?page=<seq>
+static void rota_registro(const httpd_request_t *req, httpd_response_t *resp) {
+    httpd_header(resp, "Content-Type: application/json");
+    resp->body_len = montar_json_registro(req, resp->body, sizeof(resp->body));
+}
+
+// rota /settings: com parâmetros, um envio do formulário; sem, a página de configurações
+static void rota_configuracoes(const httpd_request_t *req, httpd_response_t *resp) {
+    // os campos do formulário têm os nomes das regras (valores em °C, %, hPa, guardados em
+    // centésimos) mais a pressão ao nível do mar
+    if (req->num_params == 0) {
+        // a página é estática; os valores atuais dos campos vêm de /limits
+        servir_pagina(resp, req, &PAGINA_CONFIGURACOES);
+        return;
+    }
+    // a pressão ao nível do mar é validada antes de aplicar qualquer campo
+    const char *press_mar = httpd_param(req, "press_mar");
+    int32_t nova_pressao_mar = press_mar ? fmt_parse_fixed(press_mar, 2) : 0;
+    if (press_mar && (nova_pressao_mar < PRESSAO_MAR_MIN_PA || nova_pressao_mar > PRESSAO_MAR_MAX_PA)) {
+        httpd_status(resp, 400);
+        httpd_header(resp, "Content-Type: text/plain");
+        resp->body_len = fmt_str(resp->body, sizeof(resp->body), "press_mar fora da faixa (800 a 1100 hPa)\n");
+        return;
+    }
+    // o formulário é aplicado inteiro ou recusado: as vagas nas filas são conferidas antes
+    bool muda_pressao_mar = press_mar && nova_pressao_mar != pressao_nivel_mar_config;
+    uint32_t edicoes = 0;
+    for (uint8_t i = 0; i < req->num_params; i++) {
+        if (buscar_regra(req->params[i].key) >= 0) edicoes++;
+    }
+    if (edicoes > vagas_fila(&fila_regras) || (muda_pressao_mar && vagas_fila(&fila_pressao_mar) == 0)) {
+        responder_fila_cheia(resp);
+        return;
+    }
+    if (muda_pressao_mar) {
+        if (!spsc_ring_push(&fila_pressao_mar, &nova_pressao_mar)) {
+            responder_fila_cheia(resp);
+            return;
+        }
+        pressao_nivel_mar_config = nova_pressao_mar;
+    }
+    for (uint8_t i = 0; i < req->num_params; i++) {
+        int regra = buscar_regra(req->params[i].key);
+        if (regra >= 0 && !editar_limite((uint32_t)regra, fmt_parse_fixed(req->params[i].value, 2))) {
+            responder_fila_cheia(resp);
+            return;
+        }
+    }
+    printf("Limites atualizados via web!\n");
+
+    // envia uma resposta de redirecionamento para o navegador voltar à página principal
+    httpd_status(resp, 302);
+    httpd_header(resp, "Location: /");
+}
+
+// nomes de alert_kind_t e dos canais em /rules
+static const char *const nomes_tipos[] = { "acima", "abaixo", "subida", "queda" };
+static const char *const nomes_canais[] = { "temp", "umid", "press", "alt" };
+
+// escreve a configuração e o estado (disparada, pela última amostra) de cada regra
+static int formatar_json_regras(char *dst, size_t cap) {
+    size_t len = fmt_str(dst, cap, "[");
+    for (int i = 0; i < NUM_REGRAS; i++) {
+        const alert_rule_config_t *c = &regras_config[i];
+        len += fmt_str(dst + len, cap - len, i ? ",{\"regra\":\"" : "{\"regra\":\"");
+        len += fmt_str(dst + len, cap - len, nomes_regras[i]);
+        len += fmt_str(dst + len, cap - len, "\",\"tipo\":\"");
+        len += fmt_str(dst + len, cap - len, nomes_tipos[c->kind]);
+        len += fmt_str(dst + len, cap - len, "\",\"canal\":\"");
+        len += fmt_str(dst + len, cap - len, nomes_canais[c->channel]);
+        len += fmt_str(dst + len, cap - len, "\",\"limite\":");
+        len += fmt_fixed(dst + len, cap - len, c->threshold, 2);
+        len += fmt_str(dst + len, cap - len, ",\"histerese\":");
+        len += fmt_fixed(dst + len, cap - len, c->hysteresis, 2);
+        len += fmt_str(dst + len, cap - len, ",\"espera_ms\":");
+        len += fmt_uint(dst + len, cap - len, c->hold_ms);
+        len += fmt_str(dst + len, cap - len, ",\"janela_s\":");
+        len += fmt_uint(dst + len, cap - len, c->window_s);
+        len += fmt_str(dst + len, cap - len, c->enabled ? ",\"ativa\":true" : ",\"ativa\":false");
+        len += fmt_str(dst + len, cap - len,
+                       ultima_amostra.regras_ativas & (1u << i) ? ",\"disparada\":true}" : ",\"disparada\":false}");
+    }
+    return (int)(len + fmt_str(dst + len, cap - len, "]"));
+}
+
+// rota /rules: JSON com todas as regras. Com ?regra=<nome>, antes edita essa regra com os
+// campos informados: tipo, canal, limite e histerese (na unidade do canal, até 2 casas),
+// espera_ms, janela_s e ativa (0 ou 1)
+static void rota_regras(const httpd_request_t *req, httpd_response_t *resp) {
+    const char *nome = httpd_param(req, "regra");
+    if (nome) {
+        int regra = buscar_regra(nome);
+        const char *tipo = httpd_param(req, "tipo");
+        const char *canal = httpd_param(req, "canal");
+        int indice_tipo = tipo ? buscar_nome(nomes_tipos, 4, tipo) : 0;
+        int indice_canal = canal ? buscar_nome(nomes_canais, 4, canal) : 0;
+        if (regra < 0 || indice_tipo < 0 || indice_canal < 0) {
+            httpd_status(resp, 400);
+            return;
+        }
+        alert_rule_config_t config = regras_config[regra];
+        if (tipo) config.kind = (alert_kind_t)indice_tipo;
+        if (canal) config.channel = (uint8_t)indice_canal;
+        const char *valor;
+        if ((valor = httpd_param(req, "limite"))) config.threshold = fmt_parse_fixed(valor, 2);
+        if ((valor = httpd_param(req, "histerese"))) config.hysteresis = fmt_parse_fixed(valor, 2);
+        config.hold_ms = parametro_numerico(req, "espera_ms", config.hold_ms);
+        config.window_s = parametro_numerico(req, "janela_s", config.window_s);
+        config.enabled = parametro_numerico(req, "ativa", config.enabled) != 0;
+        if (!editar_regra((uint32_t)regra, &config)) {
+            responder_fila_cheia(resp);
+            return;
+        }
+        printf("Regra %s atualizada via web!\n", nomes_regras[regra]);
+    }
+    httpd_header(resp, "Content-Type: application/json");
+    resp->body_len = formatar_json_regras(resp->body, sizeof(resp->body));
+}
+
+// rota /limits: JSON com os limites atuais, nas chaves dos campos do formulário
+static void rota_limites(const httpd_request_t *req, httpd_response_t *resp) {
+    (void)req;
+    httpd_header(resp, "Content-Type: application/json");
+    // chave, variável (centésimos de °C, de % e de hPa) e casas decimais de cada limite
+    static const struct {
+        const char *chave;
+        const int32_t *valor;
+        uint8_t casas;
+    } limites[] = {
+        { "{\"temp_min\":", &regras_config[REGRA_TEMP_MIN].threshold, 1 },
+        { ",\"temp_max\":", &regras_config[REGRA_TEMP_MAX].threshold, 1 },
+        { ",\"umid_min\":", &regras_config[REGRA_UMID_MIN].threshold, 0 },
+        { ",\"umid_max\":", &regras_config[REGRA_UMID_MAX].threshold, 0 },
+        { ",\"press_min\":", &regras_config[REGRA_PRESS_MIN].threshold, 0 },
+        { ",\"press_max\":", &regras_config[REGRA_PRESS_MAX].threshold, 0 },
+        { ",\"press_mar\":", &pressao_nivel_mar_config, 2 },
+    };
+    size_t len = 0;
+    for (size_t i = 0; i < sizeof(limites) / sizeof(limites[0]); i++) {
+        len += fmt_str(resp->body + len, sizeof(resp->body) - len, limites[i].chave);
+        len += fmt_fixed(resp->body + len, sizeof(resp->body) - len, fmt_round(*limites[i].valor, 2 - limites[i].casas),
+                         limites[i].casas);
+    }
+    resp->body_len = len + fmt_str(resp->body + len, sizeof(resp->body) - len, "}");
+}
+
+// tabela de /metrics: séries consecutivas com o mesmo nome formam uma família
+static const metrics_entry_t tabela_metricas[] = {
+    { "estacao_uptime_seconds", "Tempo desde o boot.", METRICS_GAUGE, NULL, &metrica_uptime },
+    { "estacao_sensor_readings_total", "Leituras brutas combinadas nas amostras.", METRICS_COUNTER,
+      "sensor=\"bmp280\"", &metrica_leituras_bmp },
+    { "estacao_sensor_readings_total", NULL, METRICS_COUNTER, "sensor=\"aht20\"", &metrica_leituras_aht },
+    { "estacao_sensor_read_seconds", "Leitura de uma conversão (I2C e compensação).",
+      METRICS_HISTOGRAM, "sensor=\"bmp280\"", &metrica_leitura_bmp },
+    { "estacao_sensor_read_seconds", NULL, METRICS_HISTOGRAM, "sensor=\"aht20\"", &metrica_leitura_aht },
+    { "estacao_samples_published_total", "Amostras publicadas.", METRICS_COUNTER, NULL,
+      &metrica_amostras },
+    { "estacao_samples_dropped_total", "Amostras perdidas com a fila entre núcleos cheia.", METRICS_COUNTER,
+      NULL, &metrica_descartes },
+    { "estacao_alert_rules_active", "Regras de alerta disparadas.", METRICS_GAUGE, NULL,
+      &metrica_regras_ativas },
+    { "estacao_display_flush_seconds", "Início do envio de um quadro ao SSD1306.", METRICS_HISTOGRAM, NULL,
+      &metrica_display },
+    { "estacao_led_push_seconds", "Envio do quadro à matriz WS2812.",
+      METRICS_HISTOGRAM, NULL, &metrica_matriz },
+    { "estacao_http_recv_seconds", "Callback de recepção TCP do servidor HTTP.",
+      METRICS_HISTOGRAM, NULL, &metrica_http },
+    { "estacao_http_requests_total", "Requisições HTTP atendidas.", METRICS_COUNTER, NULL, &metrica_requisicoes },
+    { "estacao_http_rejected_total", "Conexões recusadas com 503.", METRICS_COUNTER, NULL,
+      &metrica_recusas },
+    { "estacao_http_connections", "Conexões HTTP abertas.", METRICS_GAUGE, NULL, &metrica_conexoes },
+    { "estacao_http_connection_state_bytes", "Estado das conexões (conjunto estático).",
+      METRICS_GAUGE, "state=\"in_use\"", &metrica_memoria_conexoes },
+    { "estacao_http_connection_state_bytes", NULL, METRICS_GAUGE, "state=\"reserved\"",
+      &metrica_memoria_reservada },
+    { "estacao_loop_period_seconds", "Período do laço principal de cada núcleo.",
+      METRICS_HISTOGRAM, "core=\"0\"", &metrica_laco[0] },
+#if ESTACAO_DUAL_CORE
+    { "estacao_loop_period_seconds", NULL, METRICS_HISTOGRAM, "core=\"1\"", &metrica_laco[1] },
+#endif
+};
+
+// próximo trecho de /metrics; cursor é o índice da próxima série em tabela_metricas
+static size_t gerar_metricas(char *dst, size_t cap, size_t *cursor) {
+    return metrics_format(dst, cap, tabela_metricas, sizeof(tabela_metricas) / sizeof(tabela_metricas[0]), cursor);
+}
+
+// rota /metrics: métricas de execução no formato de texto do Prometheus
+static void rota_metricas(const httpd_request_t *req, httpd_response_t *resp) {
+    (void)req;
+    // medidores lidos na hora da coleta, neste núcleo
+    httpd_stats_t estatisticas;
+    httpd_get_stats(&estatisticas);
+    metrics_counter_set(&metrica_requisicoes, estatisticas.requests);
+    metrics_counter_set(&metrica_recusas, estatisticas.rejected);
+    metrics_gauge_set(&metrica_conexoes, estatisticas.connections);
+    metrics_gauge_set(&metrica_memoria_conexoes, (int32_t)estatisticas.state_bytes);
+    metrics_gauge_set(&metrica_memoria_reservada, (int32_t)estatisticas.state_capacity);
+    metrics_counter_set(&metrica_descartes, atomic_load_explicit(&fila_amostras.dropped, memory_order_relaxed));
+    metrics_gauge_set(&metrica_regras_ativas, __builtin_popcount(ultima_amostra.regras_ativas));
+    metrics_gauge_set(&metrica_uptime, (int32_t)(time_us_64() / 1000000));
+
+    httpd_header(resp, "Content-Type: text/plain; version=0.0.4");
+    httpd_header(resp, "Cache-Control: no-store");
+    // a exposição passa do tamanho de resp->body: segue em trechos de séries inteiras
+    httpd_generated_body(resp, gerar_metricas);
+}
+
+// qualquer outra requisição (ex: "/") recebe a página principal
+static void rota_pagina_principal(const httpd_request_t *req, httpd_response_t *resp) {
+    // só o cabeçalho é montado em RAM; a página segue da flash em trechos
+    servir_pagina(resp, req, &PAGINA_PRINCIPAL);
+}
+
+// tabela de rotas: o caminho é comparado com ela enquanto a requisição chega
+static const httpd_route_t rotas[] = {
+    { HTTPD_GET, "/data", rota_dados },
+    { HTTPD_GET, "/events", rota_eventos },
+    { HTTPD_GET, "/ws", rota_websocket },
+    { HTTPD_GET, "/history", rota_historico },
+    { HTTPD_GET, "/rollup", rota_agregados },
+    { HTTPD_GET, "/log", rota_registro },
+    { HTTPD_GET, "/settings", rota_configuracoes },
+    { HTTPD_GET, "/limits", rota_limites },
+    { HTTPD_GET, "/rules", rota_regras },
+    { HTTPD_GET, "/metrics", rota_metricas },
+};
+
+// --- AQUISIÇÃO E INTERFACE LOCAL ---
+// estado do núcleo de aquisição (núcleo 1 no modo dual-core)
+static ssd1306_t ssd;
+static sensors_t sensores;
+
+// aquisição do BMP280: conversões forced a 25 Hz com pressão x4; o IIR interno fica
+// desligado porque espalharia os picos antes da mediana do estágio de filtragem;
+// compensação em 64 bits (alguns microssegundos por leitura, mesmo a 25 Hz)
+static const bmp280_config_t config_bmp280 = {
+    .osrs_temp = BMP280_OSRS_X1,
+    .osrs_press = BMP280_OSRS_X4,
+    .filter = BMP280_FILTER_OFF,
+    .standby = BMP280_STANDBY_500_MS,
+    .mode = BMP280_MODE_FORCED,
+    .compensation_64bit = true,
+};
+
+// estágio de filtragem entre os drivers e a aplicação: BMP280 a 25 Hz e AHT20 na taxa
+// máxima (~12 Hz), mediana de 5 contra picos e média das leituras de cada período de
+// amostragem (~12 de pressão e ~6 de umidade por amostra publicada)
+static const sensors_filter_config_t filtro_sensores = {
+    .bmp_interval_ms = 40,
+    .aht_interval_ms = 0,
+    .filter = { .median_n = 5, .mode = FILTER_BOXCAR, .ema_shift = 3 },
+};
+
+// inicializa os sensores, o display, os botões e as saídas locais
+static void init_aquisicao(void) {
     // inicialização do I2C e do display
     i2c_init(I2C_PORT_DISP, 400 * 1000);
     gpio_set_function(I2C_SDA_DISP, GPIO_FUNC_I2C);
@@ -468,7 +1073,6 @@ int main() {                                  // ponto de entrada do programa
     gpio_pull_up(I2C_SDA_DISP);
     gpio_pull_up(I2C_SCL_DISP);
     
-    ssd1306_t ssd;
     ssd1306_init(&ssd, 128, 64, false, ENDERECO, I2C_PORT_DISP);
     ssd1306_config(&ssd);
     
@@ -496,55 +1100,217 @@ int main() {                                  // ponto de entrada do programa
     gpio_pull_up(I2C_SDA_SENSORES);
     gpio_pull_up(I2C_SCL_SENSORES);
 
-    struct bmp280_calib_param bmp280_params;
-    bmp280_init(I2C_PORT_SENSORES);
-    bmp280_get_calib_params(I2C_PORT_SENSORES, &bmp280_params);
-
-    aht20_init(I2C_PORT_SENSORES);
+    sensors_init(&sensores, I2C_PORT_SENSORES, PERIODO_AMOSTRAGEM_MS, &config_bmp280, &filtro_sensores);
+    sensors_set_metrics(&sensores, &metrica_leitura_bmp, &metrica_leitura_aht);
     
     // inicialização da matriz de LEDs WS2812 via PIO
     PIO pio = pio0;
     uint offset = pio_add_program(pio, &ws2812_program);
     ws2812_program_init(pio, 0, offset, WS2812_PIN, 800000, false);
+    led_matrix_init(&matriz, pio, 0, BRILHO_MATRIZ);
     
-    // inicializa os periféricos restantes
-    init_led_rgb();
-    init_buzzer();
-    start_http_server();
-    printf("Sistema pronto.\n");
+    sequencer_init(&sinalizacao, LED_R, LED_G, LED_B, BUZZER_PIN); // pool de alarmes neste núcleo
+    alerts_init(&alertas, regras, regras_padrao, NUM_REGRAS, janela_regras, TAMANHO_JANELA_REGRAS,
+                PERIODO_JANELA_REGRAS_S);
+}
 
-    int32_t raw_temp, raw_press;
-    AHT20_Data aht20_data;
+// trata uma nova leitura dos sensores: altitude, alerta, saídas locais e display
+static void processar_amostra(const sensors_sample_t *leitura, amostra_t *amostra) {
+    if (leitura->bmp_ok) {
+        temperatura_bmp = leitura->temp_c100;
+        pressao_bmp = leitura->press_pa;
+    }
+    if (leitura->aht_ok) {
+        umidade_aht = leitura->umid_c100;
+    }
+
+    // calcula a altitude com base na pressão atmosférica (tabela interpolada, sem pow),
+    // com a referência mais recente vinda do servidor web
+    int32_t nova_pressao_mar;
+    while (spsc_ring_pop(&fila_pressao_mar, &nova_pressao_mar)) pressao_nivel_mar = nova_pressao_mar;
+    altitude_bmp = altitude_cm(pressao_bmp, pressao_nivel_mar);
+    metrics_counter_add(&metrica_leituras_bmp, leitura->bmp_readings);
+    metrics_counter_add(&metrica_leituras_aht, leitura->aht_readings);
+    
+    // --- LÓGICA DE ALERTA ---
+    // aplica as edições de regras vindas do servidor web e avalia a tabela com a nova amostra
+    edicao_regra_t edicao;
+    while (spsc_ring_pop(&fila_regras, &edicao)) {
+        alerts_set_rule(&alertas, edicao.indice, &edicao.config);
+    }
+    int32_t valores[ALERT_CHANNELS] = {
+        [CANAL_TEMP] = temperatura_bmp, [CANAL_UMID] = umidade_aht,
+        [CANAL_PRESS] = pressao_bmp, [CANAL_ALT] = altitude_bmp,
+    };
+    alerts_evaluate(&alertas, (uint32_t)(leitura->timestamp_us / 1000), valores);
+    int regra = regra_principal(alerts_active_mask(&alertas));
+    alerta_ativo = regra >= 0;
+                    
+    // --- ATUALIZAÇÃO DOS PERIFÉRICOS ---
+    // LED RGB e buzzer seguem o padrão da regra de maior prioridade sozinhos (só troca se mudar)
+    sequencer_play(&sinalizacao, alerta_ativo ? padroes_regras[regra] : &padrao_normal);
+    set_matriz_indicador(temperatura_bmp, 1000, 4000); // atualiza o indicador de nível da matriz (10 a 40 °C)
+    update_display(&ssd);                       // atualiza as informações no display OLED
+
+    amostra->timestamp_us = leitura->timestamp_us;
+    amostra->temp_c100 = temperatura_bmp;
+    amostra->umid_c100 = umidade_aht;
+    amostra->press_pa = pressao_bmp;
+    amostra->alt_cm = altitude_bmp;
+    amostra->regras_ativas = alerts_active_mask(&alertas);
+    amostra->alerta = alerta_ativo;
+}
+
+// disponibiliza uma amostra para o servidor web (sempre no núcleo 0)
+static void publicar_amostra(const amostra_t *amostra) {
+    // os handlers das rotas leem este estado e os callbacks do lwIP alteram as conexões no
+    // contexto do lwIP (IRQ em segundo plano com pico_cyw43_arch_lwip_threadsafe_background):
+    // a atualização e os envios são feitos com o lwIP travado
+    cyw43_arch_lwip_begin();
+    bool alerta_mudou = amostra->alerta != ultima_amostra.alerta;
+    ultima_amostra = *amostra;
+    metrics_counter_add(&metrica_amostras, 1);
+
+    // toda amostra entra nos agregados por minuto e por hora
+    int32_t valores[ROLLUP_CHANNELS] = {
+        amostra->temp_c100,                        // centésimos de °C
+        amostra->umid_c100,                        // centésimos de %
+        amostra->press_pa,                         // Pa
+        fmt_round(amostra->alt_cm, 1),             // decímetros
+    };
+    rollup_add(&agregados, (uint32_t)(amostra->timestamp_us / 1000000), valores);
+
+    // registra no histórico uma amostra a cada PERIODO_HISTORICO_MS
+    if (amostra->timestamp_us >= proximo_historico_us) {
+        proximo_historico_us += PERIODO_HISTORICO_MS * 1000ull;
+        if (proximo_historico_us <= amostra->timestamp_us) {
+            proximo_historico_us = amostra->timestamp_us + PERIODO_HISTORICO_MS * 1000ull;
+        }
+        history_record_t reg = {
+            .timestamp_ms = (uint32_t)(amostra->timestamp_us / 1000),
+            .temp_c100 = (int16_t)limitar(valores[0], INT16_MIN, INT16_MAX),
+            .umid_c100 = (uint16_t)limitar(valores[1], 0, UINT16_MAX),
+            .press_off_pa = (uint16_t)limitar(valores[2] - HISTORY_PRESS_OFFSET_PA, 0, UINT16_MAX),
+            .alt_dm = (int16_t)limitar(valores[3], INT16_MIN, INT16_MAX),
+        };
+        history_push(&historico, &reg);
+        if (registro_flash_ok) flashlog_append(&registro_flash, &reg); // gravado depois, em flashlog_task
+    }
 
+    // empurra a amostra (e a mudança de alerta) para os clientes de /events
+    char evento[192];
+    int len = 0;
+    if (alerta_mudou) {
+        len = snprintf(evento, sizeof(evento), "event: alerta\ndata: %s\n\n", amostra->alerta ? "true" : "false");
+    }
+    len += snprintf(evento + len, sizeof(evento) - len, "event: amostra\ndata: ");
+    len += formatar_json_amostra(evento + len, sizeof(evento) - len, amostra);
+    len += snprintf(evento + len, sizeof(evento) - len, "\n\n");
+    httpd_stream_broadcast(evento, (size_t)len);
+    uint8_t quadro[WS_TAMANHO_AMOSTRA];
+    montar_quadro_amostra(quadro, amostra);
+    httpd_ws_broadcast(quadro, sizeof(quadro), true);
+    cyw43_arch_lwip_end();
+}
+
+#if ESTACAO_DUAL_CORE
+// laço do núcleo 1: aquisição, display, matriz de LEDs, LED RGB e buzzer
+static void core1_main(void) {
+    flash_safe_execute_core_init();           // permite ao núcleo 0 pausar este núcleo ao gravar a flash
+    init_aquisicao();
+    amostra_t amostra;
+    uint64_t inicio_passagem = metrics_start();
+    while (true) {
+        if (sensors_task(&sensores)) {
+            processar_amostra(&sensores.sample, &amostra);
+            spsc_ring_push(&fila_amostras, &amostra); // fila cheia: a amostra é descartada
+        }
+        if (display_pendente) display_pendente = !enviar_display(&ssd);
+        led_matrix_task(&matriz);             // quadro da matriz que esperava o latch anterior
+        sleep_ms(TICK_LOOP_MS);
+        metrics_stop(&metrica_laco[1], inicio_passagem); // período da passagem, pausa incluída
+        inicio_passagem = metrics_start();
+    }
+}
+#endif
+
+// --- Função Principal (main) ---
+int main() {                                  // ponto de entrada do programa
+    stdio_init_all();                         // inicializa a comunicação serial para o printf
+    sleep_ms(2000);                           // aguarda 2 segundos para estabilizar
+    printf("Iniciando Estacao Meteorologica ...\n");
+
+    // inicializa o módulo Wi-Fi
+    if (cyw43_arch_init()) {
+        printf("Falha ao inicializar o modulo Wi-Fi\n");
+        return 1;
+    }
+    cyw43_arch_enable_sta_mode();             // habilita o modo "station" (cliente Wi-Fi)
+    printf("Conectando ao Wi-Fi...\n");
+    // tenta conectar à rede Wi-Fi com um timeout de 30 segundos
+    if (cyw43_arch_wifi_connect_timeout_ms("Apartamento 01", "12345678", CYW43_AUTH_WPA2_AES_PSK, 30000)) {
+        printf("Falha na conexao Wi-Fi\n");
+    } else {
+        printf("Conectado ao Wi-Fi\n");
+        // obtém e exibe o endereço IP
+        uint8_t *ip = (uint8_t *)&(cyw43_state.netif[0].ip_addr.addr);
+        snprintf(ip_str, sizeof(ip_str), "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
+        printf("IP: %s\n", ip_str);
+    }
+    
+    spsc_ring_init(&fila_amostras, fila_amostras_buffer, sizeof(amostra_t), TAMANHO_FILA_AMOSTRAS);
+    spsc_ring_init(&fila_regras, fila_regras_buffer, sizeof(edicao_regra_t), TAMANHO_FILA_REGRAS);
+    spsc_ring_init(&fila_pressao_mar, fila_pressao_mar_buffer, sizeof(int32_t), TAMANHO_FILA_PRESSAO_MAR);
+    memcpy(regras_config, regras_padrao, sizeof(regras_config));
+    history_init(&historico, historico_buffer, TAMANHO_HISTORICO);
+    rollup_tier_init(&camadas_agregados[0], 60, agregados_minuto, AGREGADOS_MINUTO);
+    rollup_tier_init(&camadas_agregados[1], 3600, agregados_hora, AGREGADOS_HORA);
+    rollup_init(&agregados, camadas_agregados, 2);
+    registro_flash_ok = flashlog_init(&registro_flash, REGISTRO_FLASH_OFFSET, REGISTRO_FLASH_TAMANHO,
+                                      sizeof(history_record_t));
+    printf("Registro na flash: boot %u, %lu paginas\n", registro_flash.boot,
+           (unsigned long)(flashlog_next_seq(&registro_flash) - flashlog_first_seq(&registro_flash)));
+#if ESTACAO_DUAL_CORE
+    // o núcleo 1 assume os barramentos I2C, a interface local e as saídas de alerta
+    multicore_launch_core1(core1_main);
+#else
+    init_aquisicao();
+#endif
+    httpd_init(80, rotas, sizeof(rotas) / sizeof(rotas[0]), rota_pagina_principal); // servidor HTTP na porta 80
+    httpd_set_metrics(&metrica_http);
+    printf("Sistema pronto.\n");
+
+    amostra_t amostra;
+    uint64_t inicio_passagem = metrics_start();
     // loop principal infinito
     while (true) {
         cyw43_arch_poll(); // processa eventos de rede (essencial para o servidor web funcionar)
-        
-        // --- LEITURA E PROCESSAMENTO DOS SENSORES ---
-        bmp280_read_raw(I2C_PORT_SENSORES, &raw_temp, &raw_press);
-        temperatura_bmp = bmp280_convert_temp(raw_temp, &bmp280_params) / 100.0f;
-        pressao_bmp = bmp280_convert_pressure(raw_press, raw_temp, &bmp280_params) / 100.0f;
-
-        if (aht20_read(I2C_PORT_SENSORES, &aht20_data)) {
-            umidade_aht = aht20_data.humidity;
+        // no máximo uma operação de flash por passagem, para a rede ser atendida entre elas;
+        // /log lê a cabeça do registro no contexto do lwIP
+        if (registro_flash_ok) {
+            cyw43_arch_lwip_begin();
+            flashlog_task(&registro_flash);
+            cyw43_arch_lwip_end();
         }
 
-        // calcula a altitude com base na pressão atmosférica
-        altitude_bmp = 44330.0 * (1.0 - pow(pressao_bmp / 1013.25, 0.1903));
-        
-        // --- LÓGICA DE ALERTA ---
-        // verifica se alguma das leituras está fora dos limites configurados
-        alerta_ativo = (temperatura_bmp > temp_lim_max || temperatura_bmp < temp_lim_min ||
-                        umidade_aht > umid_lim_max     || umidade_aht < umid_lim_min ||
-                        pressao_bmp > press_lim_max    || pressao_bmp < press_lim_min);
-                        
-        // --- ATUALIZAÇÃO DOS PERIFÉRICOS ---
-        set_led_rgb(alerta_ativo);                  // atualiza o LED RGB de status
-        set_buzzer(alerta_ativo);                   // atualiza o buzzer de alerta
-        set_matriz_indicador(temperatura_bmp, 10.0, 40.0); // atualiza o indicador de nível da matriz
-        update_display(&ssd);                       // atualiza as informações no display OLED
-        
-        sleep_ms(500);                              // aguarda 500ms antes da próxima iteração do loop
+#if ESTACAO_DUAL_CORE
+        // consome as amostras publicadas pelo núcleo 1
+        while (spsc_ring_pop(&fila_amostras, &amostra)) {
+            publicar_amostra(&amostra);
+        }
+#else
+        // --- LEITURA E PROCESSAMENTO DOS SENSORES ---
+        // avança a máquina de estados; só há trabalho quando uma nova amostra fica pronta
+        if (sensors_task(&sensores)) {
+            processar_amostra(&sensores.sample, &amostra);
+            publicar_amostra(&amostra);
+        }
+        if (display_pendente) display_pendente = !enviar_display(&ssd);
+        led_matrix_task(&matriz);             // quadro da matriz que esperava o latch anterior
+#endif
+        sleep_ms(TICK_LOOP_MS);                     // cede tempo à rede até a próxima passagem
+        metrics_stop(&metrica_laco[0], inicio_passagem);
+        inicio_passagem = metrics_start();
     }
     return 0; // fim do programa
 }
\ No newline at end of file
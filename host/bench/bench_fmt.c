@@ -0,0 +1,67 @@
+// Benchmark de host: JSON de /data formatado com snprintf("%.2f") e com lib/fmt.
+// Confere antes que as duas versões produzem o mesmo texto numa faixa de valores.
+// Uso: bench_fmt [iterações]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fmt.h"
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int json_snprintf(char *dst, size_t cap, const float v[4], int alerta) {
+    return snprintf(dst, cap, "{\"temp\":%.2f, \"hum\":%.2f, \"press\":%.2f, \"alt\":%.2f, \"alerta\":%s}",
+                    v[0], v[1], v[2], v[3], alerta ? "true" : "false");
+}
+
+static int json_fmt(char *dst, size_t cap, const float v[4], int alerta) {
+    size_t len = fmt_str(dst, cap, "{\"temp\":");
+    len += fmt_fixed(dst + len, cap - len, fmt_scale(v[0], 2), 2);
+    len += fmt_str(dst + len, cap - len, ", \"hum\":");
+    len += fmt_fixed(dst + len, cap - len, fmt_scale(v[1], 2), 2);
+    len += fmt_str(dst + len, cap - len, ", \"press\":");
+    len += fmt_fixed(dst + len, cap - len, fmt_scale(v[2], 2), 2);
+    len += fmt_str(dst + len, cap - len, ", \"alt\":");
+    len += fmt_fixed(dst + len, cap - len, fmt_scale(v[3], 2), 2);
+    len += fmt_str(dst + len, cap - len, alerta ? ", \"alerta\":true}" : ", \"alerta\":false}");
+    return (int)len;
+}
+
+int main(int argc, char **argv) {
+    long iteracoes = argc > 1 ? atol(argv[1]) : 1000000;
+    char a[128], b[128];
+
+    // valores com exatamente duas casas, como os que saem dos sensores em ponto fixo
+    long diferencas = 0;
+    for (int32_t c = -5000; c <= 5000; c++) {
+        float v[4] = { c / 100.0f, (c + 5000) / 100.0f, 1000.0f + c / 100.0f, c / 10.0f };
+        json_snprintf(a, sizeof(a), v, c & 1);
+        json_fmt(b, sizeof(b), v, c & 1);
+        if (strcmp(a, b) != 0 && diferencas++ < 3) printf("diferente: %s | %s\n", a, b);
+    }
+    printf("conferência: %ld diferenças em 10001 amostras\n", diferencas);
+
+    float v[4] = { 27.35f, 50.49f, 1000.33f, 108.13f };
+    volatile int sink = 0;
+    double t0 = agora_s();
+    for (long i = 0; i < iteracoes; i++) {
+        v[0] += 0.01f;
+        sink += json_snprintf(a, sizeof(a), v, 0);
+    }
+    double t1 = agora_s();
+    v[0] = 27.35f;
+    for (long i = 0; i < iteracoes; i++) {
+        v[0] += 0.01f;
+        sink += json_fmt(b, sizeof(b), v, 0);
+    }
+    double t2 = agora_s();
+    printf("snprintf: %.1f ns/resposta\n", (t1 - t0) * 1e9 / iteracoes);
+    printf("fmt:      %.1f ns/resposta (%.1fx)\n", (t2 - t1) * 1e9 / iteracoes, (t1 - t0) / (t2 - t1));
+    return sink == 0;
+}
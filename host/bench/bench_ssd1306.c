@@ -0,0 +1,174 @@
+// Benchmark de host: primitivas de desenho do SSD1306 por byte (lib/ssd1306.c) contra as
+// versões originais pixel a pixel, copiadas abaixo como referência.
+// Confere antes que as duas produzem o mesmo ram_buffer para operações aleatórias dentro
+// da tela. Uso: bench_ssd1306 [iterações]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ssd1306.h"
+#include "font.h"
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// --- referência: implementação pixel a pixel ---
+static void ref_fill(ssd1306_t *ssd, bool value) {
+    for (uint8_t y = 0; y < ssd->height; ++y)
+        for (uint8_t x = 0; x < ssd->width; ++x)
+            ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+    for (uint8_t x = left; x < left + width; ++x) {
+        ssd1306_pixel(ssd, x, top, value);
+        ssd1306_pixel(ssd, x, top + height - 1, value);
+    }
+    for (uint8_t y = top; y < top + height; ++y) {
+        ssd1306_pixel(ssd, left, y, value);
+        ssd1306_pixel(ssd, left + width - 1, y, value);
+    }
+    if (fill) {
+        for (uint8_t x = left + 1; x < left + width - 1; ++x)
+            for (uint8_t y = top + 1; y < top + height - 1; ++y)
+                ssd1306_pixel(ssd, x, y, value);
+    }
+}
+
+static void ref_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+    for (uint8_t x = x0; x <= x1; ++x)
+        ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+    for (uint8_t y = y0; y <= y1; ++y)
+        ssd1306_pixel(ssd, x, y, value);
+}
+
+static void ref_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+    uint16_t index = (c >= ' ' && c <= '~') ? (uint16_t)((c - ' ') * 8) : 0;
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t line = font[index + i];
+        for (uint8_t j = 0; j < 8; ++j)
+            ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+    }
+}
+
+static void ref_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y) {
+    while (*str) {
+        ref_draw_char(ssd, *str++, x, y);
+        x += 8;
+        if (x + 8 >= ssd->width) {
+            x = 0;
+            y += 8;
+        }
+        if (y + 8 >= ssd->height) break;
+    }
+}
+
+// --- conferência ---
+static uint32_t rng = 0x12345678u;
+
+static uint32_t aleatorio(uint32_t n) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+// aplica a mesma operação aleatória nos dois buffers
+static void operacao(ssd1306_t *ref, ssd1306_t *novo) {
+    bool v = aleatorio(2);
+    switch (aleatorio(6)) {
+        case 0:
+            ref_fill(ref, v);
+            ssd1306_fill(novo, v);
+            break;
+        case 1: {
+            uint8_t left = aleatorio(128), top = aleatorio(64);
+            uint8_t w = 1 + aleatorio(128 - left), h = 1 + aleatorio(64 - top);
+            bool fill = aleatorio(2);
+            ref_rect(ref, top, left, w, h, v, fill);
+            ssd1306_rect(novo, top, left, w, h, v, fill);
+            break;
+        }
+        case 2: {
+            uint8_t x0 = aleatorio(128), x1 = x0 + aleatorio(128 - x0), y = aleatorio(64);
+            ref_hline(ref, x0, x1, y, v);
+            ssd1306_hline(novo, x0, x1, y, v);
+            break;
+        }
+        case 3: {
+            uint8_t y0 = aleatorio(64), y1 = y0 + aleatorio(64 - y0), x = aleatorio(128);
+            ref_vline(ref, x, y0, y1, v);
+            ssd1306_vline(novo, x, y0, y1, v);
+            break;
+        }
+        case 4: {
+            char c = (char)(' ' + aleatorio(96));
+            uint8_t x = aleatorio(121), y = aleatorio(57);
+            ref_draw_char(ref, c, x, y);
+            ssd1306_draw_char(novo, c, x, y);
+            break;
+        }
+        default: {
+            char s[20];
+            size_t n = aleatorio(sizeof(s));
+            for (size_t i = 0; i < n; i++) s[i] = (char)(' ' + aleatorio(95));
+            s[n] = '\0';
+            uint8_t x = aleatorio(120), y = aleatorio(56);
+            ref_draw_string(ref, s, x, y);
+            ssd1306_draw_string(novo, s, x, y);
+            break;
+        }
+    }
+}
+
+// tela típica de update_display: limpa, dois textos, linha separadora e um retângulo
+static void tela_ref(ssd1306_t *ssd, int i) {
+    ref_fill(ssd, false);
+    ref_draw_string(ssd, "Temperatura:", 20, 4);
+    ref_draw_string(ssd, i & 1 ? "27.4 C" : "27.5 C", 38, 21);
+    ref_hline(ssd, 0, 127, 34, true);
+    ref_rect(ssd, 40, 10, 108, 20, true, true);
+}
+
+static void tela_nova(ssd1306_t *ssd, int i) {
+    ssd1306_fill(ssd, false);
+    ssd1306_draw_string(ssd, "Temperatura:", 20, 4);
+    ssd1306_draw_string(ssd, i & 1 ? "27.4 C" : "27.5 C", 38, 21);
+    ssd1306_hline(ssd, 0, 127, 34, true);
+    ssd1306_rect(ssd, 40, 10, 108, 20, true, true);
+}
+
+int main(int argc, char **argv) {
+    long iteracoes = argc > 1 ? atol(argv[1]) : 20000;
+    ssd1306_t ref, novo;
+    ssd1306_init(&ref, 128, 64, false, 0x3C, NULL);
+    ssd1306_init(&novo, 128, 64, false, 0x3C, NULL);
+
+    long diferencas = 0;
+    const int operacoes = 200000;
+    for (int i = 0; i < operacoes; i++) {
+        operacao(&ref, &novo);
+        if (memcmp(ref.ram_buffer, novo.ram_buffer, ref.bufsize) != 0) {
+            if (diferencas++ < 3) printf("diferente na operação %d\n", i);
+            memcpy(novo.ram_buffer, ref.ram_buffer, ref.bufsize);
+        }
+    }
+    printf("conferência: %ld diferenças em %d operações\n", diferencas, operacoes);
+
+    double t0 = agora_s();
+    for (long i = 0; i < iteracoes; i++) tela_ref(&ref, (int)i);
+    double t1 = agora_s();
+    for (long i = 0; i < iteracoes; i++) tela_nova(&novo, (int)i);
+    double t2 = agora_s();
+    printf("pixel a pixel: %.2f us/tela\n", (t1 - t0) * 1e6 / iteracoes);
+    printf("por byte:      %.2f us/tela (%.1fx)\n", (t2 - t1) * 1e6 / iteracoes, (t1 - t0) / (t2 - t1));
+    return diferencas != 0 || memcmp(ref.ram_buffer, novo.ram_buffer, ref.bufsize) != 0;
+}
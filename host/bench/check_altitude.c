@@ -0,0 +1,52 @@
+// Verificação de host: altitude de lib/altitude.c (tabela interpolada em ponto fixo)
+// contra a fórmula 44330 * (1 - pow(p / p0, 0.1903)) em double, para várias pressões de
+// referência, e o custo de cada uma. Termina com erro se o desvio passar do limite.
+// Uso: check_altitude
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "altitude.h"
+
+#define ERRO_MAXIMO_CM 5.0
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(void) {
+    static const int32_t referencias[] = { 95000, 98000, 101325, 103000, 105000 };
+    double pior = 0;
+    int32_t pior_p = 0, pior_p0 = 0;
+    for (size_t r = 0; r < sizeof(referencias) / sizeof(referencias[0]); r++) {
+        int32_t p0 = referencias[r];
+        // faixa coberta pela tabela: 0.5 <= p / p0 <= 1.125
+        for (int32_t p = (p0 + 1) / 2; p <= p0 * 9 / 8; p++) {
+            double esperado = 44330.0 * (1.0 - pow((double)p / p0, 0.1903)) * 100.0;
+            double erro = fabs(altitude_cm(p, p0) - esperado);
+            if (erro > pior) {
+                pior = erro;
+                pior_p = p;
+                pior_p0 = p0;
+            }
+        }
+    }
+    printf("erro máximo: %.2f cm (p = %ld Pa, p0 = %ld Pa), limite %.1f cm\n", pior, (long)pior_p,
+           (long)pior_p0, ERRO_MAXIMO_CM);
+
+    const long n = 10000000;
+    volatile int64_t sink = 0;
+    double t0 = agora_s();
+    for (long i = 0; i < n; i++) sink += altitude_cm(80000 + (int32_t)(i & 0x7FFF), 101325);
+    double t1 = agora_s();
+    for (long i = 0; i < n; i++) {
+        sink += (int64_t)(44330.0 * (1.0 - pow((80000 + (i & 0x7FFF)) / 101325.0, 0.1903)) * 100.0);
+    }
+    double t2 = agora_s();
+    printf("tabela: %.1f ns, pow: %.1f ns por cálculo\n", (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / n);
+    return pior <= ERRO_MAXIMO_CM ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+// HAL de host: flash QSPI simulada em arquivo
+// O conteúdo persiste entre execuções do binário, como a flash da placa entre boots.
+// Apagar e gravar bloqueiam pelo tempo típico do W25Q16 para expor o custo real.
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#define HOST_FLASH_ERASE_US 45000   // apagamento de um setor de 4 KB
+#define HOST_FLASH_PROGRAM_US 400   // gravação de uma página de 256 bytes
+
+// arquivo padrão da flash; o build de host aponta para o diretório de build
+#ifndef HOST_FLASH_DEFAULT_PATH
+#define HOST_FLASH_DEFAULT_PATH "flash.bin"
+#endif
+
+uint8_t *host_flash_xip;
+
+static pthread_mutex_t flash_lock = PTHREAD_MUTEX_INITIALIZER;
+
+__attribute__((constructor)) static void host_flash_open(void) {
+    const char *path = getenv("ESTACAO_FLASH_PATH");
+    if (!path) path = HOST_FLASH_DEFAULT_PATH;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        host_log("flash", "falha ao abrir %s", path);
+        abort();
+    }
+    bool novo = st.st_size < PICO_FLASH_SIZE_BYTES;
+    if (novo && ftruncate(fd, PICO_FLASH_SIZE_BYTES) != 0) {
+        host_log("flash", "falha ao dimensionar %s", path);
+        abort();
+    }
+    host_flash_xip = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (host_flash_xip == MAP_FAILED) {
+        host_log("flash", "falha ao mapear %s", path);
+        abort();
+    }
+    // um arquivo novo representa um chip apagado
+    if (novo) memset(host_flash_xip + st.st_size, 0xFF, PICO_FLASH_SIZE_BYTES - st.st_size);
+}
+
+static void flash_delay(uint32_t us) {
+    struct timespec ts = { .tv_sec = 0, .tv_nsec = (long)us * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        host_log("flash", "apagamento desalinhado: 0x%06x +%zu", (unsigned)flash_offs, count);
+        abort();
+    }
+    memset(host_flash_xip + flash_offs, 0xFF, count);
+    flash_delay(HOST_FLASH_ERASE_US * (uint32_t)(count / FLASH_SECTOR_SIZE));
+    host_log("flash", "setor 0x%06x apagado", (unsigned)flash_offs);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        host_log("flash", "gravacao desalinhada: 0x%06x +%zu", (unsigned)flash_offs, count);
+        abort();
+    }
+    // NOR: a gravação só leva bits de 1 para 0
+    for (size_t i = 0; i < count; i++) host_flash_xip[flash_offs + i] &= data[i];
+    flash_delay(HOST_FLASH_PROGRAM_US * (uint32_t)(count / FLASH_PAGE_SIZE));
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    pthread_mutex_lock(&flash_lock);
+    func(param);
+    pthread_mutex_unlock(&flash_lock);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+bool flash_safe_execute_core_deinit(void) {
+    return true;
+}
@@ -0,0 +1,479 @@
+// HAL de host: tempo, alarmes, GPIO, PWM, PIO e DMA
+// Os periféricos de saída (LED RGB, buzzer, matriz WS2812) não existem no PC; suas
+// mudanças de estado são registradas no log (stderr) para inspeção e testes.
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/dma.h"
+#include "host_hal.h"
+
+// --- Tempo ---
+static uint64_t boot_ns;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+__attribute__((constructor)) static void host_boot(void) {
+    boot_ns = monotonic_ns();
+}
+
+uint64_t time_us_64(void) {
+    return (monotonic_ns() - boot_ns) / 1000u;
+}
+
+void sleep_us(uint64_t us) {
+    uint64_t deadline = time_us_64() + us;
+    // no núcleo 0 a rede continua sendo atendida durante a espera
+    if (host_is_core0()) {
+        uint64_t now;
+        while ((now = time_us_64()) < deadline) {
+            host_net_service((int)((deadline - now + 999) / 1000));
+        }
+        return;
+    }
+    struct timespec ts = { .tv_sec = (time_t)(us / 1000000u), .tv_nsec = (long)(us % 1000000u) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+bool stdio_init_all(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+
+// --- Alarmes ---
+#define HOST_MAX_ALARMS 16
+
+struct alarm_pool {
+    int unused;
+};
+
+static struct alarm_pool host_alarm_pool;
+
+static struct {
+    alarm_id_t id;                  // 0: posição livre
+    uint64_t target_us;
+    alarm_callback_t callback;
+    void *user_data;
+} alarms[HOST_MAX_ALARMS];
+
+static alarm_id_t next_alarm_id = 1;
+static pthread_mutex_t alarm_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t alarm_cond;
+static bool alarm_thread_started;
+
+// thread no papel da IRQ do timer: dorme até o alarme mais próximo e chama o callback com
+// alarm_lock travado, para cancel_alarm nunca ver um callback pela metade
+static void *alarm_thread(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&alarm_lock);
+    while (true) {
+        int next = -1;
+        for (int i = 0; i < HOST_MAX_ALARMS; i++) {
+            if (alarms[i].id && (next < 0 || alarms[i].target_us < alarms[next].target_us)) next = i;
+        }
+        if (next < 0) {
+            pthread_cond_wait(&alarm_cond, &alarm_lock);
+            continue;
+        }
+        uint64_t now = time_us_64();
+        if (now < alarms[next].target_us) {
+            uint64_t wake_ns = boot_ns + alarms[next].target_us * 1000u;
+            struct timespec ts = { .tv_sec = (time_t)(wake_ns / 1000000000u), .tv_nsec = (long)(wake_ns % 1000000000u) };
+            pthread_cond_timedwait(&alarm_cond, &alarm_lock, &ts);
+            continue;
+        }
+        int64_t again = alarms[next].callback(alarms[next].id, alarms[next].user_data);
+        if (again == 0) {
+            alarms[next].id = 0;
+        } else if (again < 0) {
+            alarms[next].target_us += (uint64_t)(-again);
+        } else {
+            alarms[next].target_us = time_us_64() + (uint64_t)again;
+        }
+    }
+    return NULL;
+}
+
+alarm_pool_t *alarm_pool_create_with_unused_hardware_alarm(uint max_timers) {
+    (void)max_timers;
+    return &host_alarm_pool;
+}
+
+alarm_id_t alarm_pool_add_alarm_in_us(alarm_pool_t *pool, uint64_t us, alarm_callback_t callback, void *user_data,
+                                      bool fire_if_past) {
+    (void)pool;
+    (void)fire_if_past;
+    pthread_mutex_lock(&alarm_lock);
+    if (!alarm_thread_started) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&alarm_cond, &attr);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, alarm_thread, NULL) != 0) {
+            host_log("alarm", "falha ao iniciar a thread de alarmes");
+            abort();
+        }
+        pthread_detach(thread);
+        alarm_thread_started = true;
+    }
+    alarm_id_t id = -1;
+    for (int i = 0; i < HOST_MAX_ALARMS; i++) {
+        if (alarms[i].id == 0) {
+            id = next_alarm_id++;
+            if (next_alarm_id <= 0) next_alarm_id = 1;
+            alarms[i].id = id;
+            alarms[i].target_us = time_us_64() + us;
+            alarms[i].callback = callback;
+            alarms[i].user_data = user_data;
+            pthread_cond_signal(&alarm_cond);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&alarm_lock);
+    return id;
+}
+
+bool alarm_pool_cancel_alarm(alarm_pool_t *pool, alarm_id_t alarm_id) {
+    (void)pool;
+    bool found = false;
+    pthread_mutex_lock(&alarm_lock);
+    for (int i = 0; i < HOST_MAX_ALARMS; i++) {
+        if (alarm_id > 0 && alarms[i].id == alarm_id) {
+            alarms[i].id = 0;
+            found = true;
+        }
+    }
+    pthread_mutex_unlock(&alarm_lock);
+    return found;
+}
+
+// --- Núcleo 1 ---
+static void *core1_thread_entry(void *arg) {
+    void (*entry)(void) = (void (*)(void))arg;
+    entry();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, core1_thread_entry, (void *)entry) != 0) {
+        host_log("multicore", "falha ao iniciar o nucleo 1");
+        abort();
+    }
+    pthread_detach(thread);
+}
+
+void multicore_reset_core1(void) {}
+
+// --- Log ---
+static int log_enabled = -1;
+
+void host_log(const char *subsys, const char *fmt, ...) {
+    if (log_enabled < 0) {
+        const char *env = getenv("ESTACAO_HAL_LOG");
+        log_enabled = !(env && strcmp(env, "0") == 0);
+    }
+    if (!log_enabled) return;
+
+    uint64_t now = time_us_64();
+    char line[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    fprintf(stderr, "[%5llu.%03llu] [%s] %s\n", (unsigned long long)(now / 1000000u),
+            (unsigned long long)(now / 1000u % 1000u), subsys, line);
+}
+
+// --- GPIO ---
+static struct {
+    bool out;
+    bool value;
+    uint8_t function;
+    uint32_t irq_events;
+} gpios[NUM_BANK0_GPIOS];
+
+static gpio_irq_callback_t gpio_callback;
+
+void gpio_init(uint gpio) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    gpios[gpio].out = false;
+    gpios[gpio].value = false;
+    gpios[gpio].function = GPIO_FUNC_SIO;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    if (gpio < NUM_BANK0_GPIOS) gpios[gpio].out = out;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    if (gpio < NUM_BANK0_GPIOS) gpios[gpio].function = (uint8_t)fn;
+}
+
+void gpio_pull_up(uint gpio) {
+    // entradas com pull-up leem nível alto enquanto nenhum botão é pressionado
+    if (gpio < NUM_BANK0_GPIOS && !gpios[gpio].out) gpios[gpio].value = true;
+}
+
+void gpio_pull_down(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS && !gpios[gpio].out) gpios[gpio].value = false;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio >= NUM_BANK0_GPIOS || gpios[gpio].value == value) return;
+    gpios[gpio].value = value;
+    host_log("gpio", "GP%u=%d", gpio, value);
+}
+
+bool gpio_get(uint gpio) {
+    return gpio < NUM_BANK0_GPIOS && gpios[gpio].value;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    if (gpio >= NUM_BANK0_GPIOS) return;
+    if (enabled) gpios[gpio].irq_events |= events;
+    else gpios[gpio].irq_events &= ~events;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    gpio_callback = callback;
+    gpio_set_irq_enabled(gpio, events, enabled);
+}
+
+void host_gpio_key(char c) {
+    uint gpio;
+    switch (c) {
+        case 'a': case 'A': gpio = 5; break;
+        case 'b': case 'B': gpio = 6; break;
+        case 'j': case 'J': gpio = 22; break;
+        default: return;
+    }
+    host_log("gpio", "botao GP%u pressionado", gpio);
+    if (gpio_callback && (gpios[gpio].irq_events & GPIO_IRQ_EDGE_FALL)) {
+        gpio_callback(gpio, GPIO_IRQ_EDGE_FALL);
+    }
+}
+
+// --- PWM ---
+static uint16_t pwm_levels[NUM_BANK0_GPIOS];
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    host_log("pwm", "slice %u wrap=%u", slice_num, wrap);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    host_log("pwm", "slice %u clkdiv=%.2f", slice_num, divider);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    host_log("pwm", "slice %u %s", slice_num, enabled ? "habilitado" : "desabilitado");
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    if (gpio >= NUM_BANK0_GPIOS || pwm_levels[gpio] == level) return;
+    pwm_levels[gpio] = level;
+    host_log("pwm", "GP%u nivel=%u", gpio, level);
+}
+
+// --- PIO ---
+// tempo mínimo em nível baixo que o WS2812 interpreta como fim de quadro
+#define HOST_PIO_LATCH_US 280
+#define HOST_PIO_MAX_WORDS 64
+
+pio_hw_t pio0_hw;
+pio_hw_t pio1_hw;
+
+static struct {
+    uint32_t words[HOST_PIO_MAX_WORDS];
+    uint32_t last[HOST_PIO_MAX_WORDS];
+    size_t count;
+    size_t last_count;
+    uint64_t last_put_us;
+} pio_frame;
+
+// o quadro é escrito pelo núcleo de aquisição e fechado também pelo serviço de rede
+static pthread_mutex_t pio_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// registra o quadro acumulado se o tempo de latch já passou desde a última palavra
+static void pio_latch_locked(void) {
+    if (pio_frame.count == 0 || time_us_64() - pio_frame.last_put_us < HOST_PIO_LATCH_US) return;
+
+    if (pio_frame.count != pio_frame.last_count ||
+        memcmp(pio_frame.words, pio_frame.last, pio_frame.count * sizeof(uint32_t)) != 0) {
+        char line[HOST_PIO_MAX_WORDS * 7 + 1];
+        size_t pos = 0;
+        for (size_t i = 0; i < pio_frame.count; i++) {
+            // palavra GRB alinhada à esquerda (24 bits úteis)
+            pos += (size_t)snprintf(line + pos, sizeof(line) - pos, "%06x ", (unsigned)(pio_frame.words[i] >> 8));
+        }
+        host_log("ws2812", "%zu px: %s", pio_frame.count, line);
+        memcpy(pio_frame.last, pio_frame.words, pio_frame.count * sizeof(uint32_t));
+        pio_frame.last_count = pio_frame.count;
+    }
+    pio_frame.count = 0;
+}
+
+void host_pio_latch(void) {
+    pthread_mutex_lock(&pio_lock);
+    pio_latch_locked();
+    pthread_mutex_unlock(&pio_lock);
+}
+
+uint pio_add_program(PIO pio, const struct pio_program *program) {
+    (void)pio;
+    (void)program;
+    return 0;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio == pio0 ? GPIO_FUNC_PIO0 : GPIO_FUNC_PIO1);
+}
+
+int pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    (void)pio;
+    (void)sm;
+    for (uint i = 0; i < pin_count; i++) gpio_set_dir(pin_base + i, is_out);
+    return PICO_OK;
+}
+
+int pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+    (void)pio;
+    (void)sm;
+    (void)initial_pc;
+    (void)config;
+    return PICO_OK;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    (void)pio;
+    (void)sm;
+    (void)enabled;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    (void)pio;
+    (void)sm;
+    pthread_mutex_lock(&pio_lock);
+    pio_latch_locked();
+    if (pio_frame.count < HOST_PIO_MAX_WORDS) pio_frame.words[pio_frame.count++] = data;
+    pio_frame.last_put_us = time_us_64();
+    pthread_mutex_unlock(&pio_lock);
+}
+
+// palavras escritas por DMA na FIFO de uma máquina: entram no quadro como se fossem
+// colocadas uma a uma; retorna o tempo de transmissão a 800 kHz (24 bits por palavra)
+// ou -1 se write_addr não for uma FIFO de TX
+static int64_t pio_dma_write(volatile void *write_addr, const uint32_t *words, size_t count) {
+    PIO pio = NULL;
+    uint sm = 0;
+    for (uint i = 0; i < 4; i++) {
+        if (write_addr == &pio0_hw.txf[i]) pio = pio0, sm = i;
+        if (write_addr == &pio1_hw.txf[i]) pio = pio1, sm = i;
+    }
+    if (!pio) return -1;
+    for (size_t i = 0; i < count; i++) pio_sm_put_blocking(pio, sm, words[i]);
+    return (int64_t)count * 30;
+}
+
+// --- DMA ---
+// campos de dma_channel_config.ctrl na HAL de host
+#define HOST_DMA_SIZE_MASK 0x3u
+#define HOST_DMA_INCR_READ 0x4u
+#define HOST_DMA_INCR_WRITE 0x8u
+#define HOST_DMA_DREQ_SHIFT 8
+
+static struct {
+    bool claimed;
+    uint64_t busy_until_us;
+} dma_channels[NUM_DMA_CHANNELS];
+
+static pthread_mutex_t dma_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int dma_claim_unused_channel(bool required) {
+    pthread_mutex_lock(&dma_lock);
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!dma_channels[i].claimed) {
+            dma_channels[i].claimed = true;
+            pthread_mutex_unlock(&dma_lock);
+            return (int)i;
+        }
+    }
+    pthread_mutex_unlock(&dma_lock);
+    if (required) {
+        fprintf(stderr, "dma: nenhum canal livre\n");
+        abort();
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    if (channel < NUM_DMA_CHANNELS) dma_channels[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    // como no SDK: 32 bits, incrementa a leitura, não incrementa a escrita, sem DREQ
+    dma_channel_config c = { DMA_SIZE_32 | HOST_DMA_INCR_READ };
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    c->ctrl = (c->ctrl & ~HOST_DMA_SIZE_MASK) | (uint32_t)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    c->ctrl = incr ? c->ctrl | HOST_DMA_INCR_READ : c->ctrl & ~HOST_DMA_INCR_READ;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    c->ctrl = incr ? c->ctrl | HOST_DMA_INCR_WRITE : c->ctrl & ~HOST_DMA_INCR_WRITE;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    c->ctrl = (c->ctrl & ((1u << HOST_DMA_DREQ_SHIFT) - 1)) | (dreq << HOST_DMA_DREQ_SHIFT);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    if (channel >= NUM_DMA_CHANNELS || !trigger) return;
+    // só transferências de memória para um registrador fixo de periférico são simuladas
+    int64_t us = -1;
+    if ((config->ctrl & HOST_DMA_SIZE_MASK) == DMA_SIZE_16 && !(config->ctrl & HOST_DMA_INCR_WRITE)) {
+        us = host_i2c_dma_write(write_addr, (const uint16_t *)read_addr, transfer_count);
+    } else if ((config->ctrl & HOST_DMA_SIZE_MASK) == DMA_SIZE_32 && !(config->ctrl & HOST_DMA_INCR_WRITE)) {
+        us = pio_dma_write(write_addr, (const uint32_t *)read_addr, transfer_count);
+    }
+    if (us < 0) {
+        host_log("dma", "canal %u: destino %p não simulado", channel, (void *)write_addr);
+        return;
+    }
+    pthread_mutex_lock(&dma_lock);
+    dma_channels[channel].busy_until_us = time_us_64() + (uint64_t)us;
+    pthread_mutex_unlock(&dma_lock);
+}
+
+bool dma_channel_is_busy(uint channel) {
+    if (channel >= NUM_DMA_CHANNELS) return false;
+    pthread_mutex_lock(&dma_lock);
+    bool busy = time_us_64() < dma_channels[channel].busy_until_us;
+    pthread_mutex_unlock(&dma_lock);
+    return busy;
+}
@@ -0,0 +1,22 @@
+// HAL de host: funções internas compartilhadas entre os módulos da HAL
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include "pico.h"
+
+// true na thread que inicializou a rede (equivalente ao núcleo 0)
+bool host_is_core0(void);
+
+// atende os sockets por até timeout_ms milissegundos e entrega os callbacks tcp_*
+void host_net_service(int timeout_ms);
+
+// fecha o quadro WS2812 pendente quando o tempo de reset já passou
+void host_pio_latch(void);
+
+// entrega ao dispositivo I2C as palavras de data_cmd escritas por um canal de DMA;
+// retorna a duração da transferência no barramento (us) ou -1 se write_addr não for
+// o data_cmd de um barramento I2C
+int64_t host_i2c_dma_write(volatile void *write_addr, const uint16_t *words, size_t count);
+
+#endif
@@ -0,0 +1,22 @@
+// HAL de host: relógios do RP2040 (valores nominais)
+
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6,
+    clk_usb = 7,
+    clk_adc = 8,
+    clk_rtc = 9,
+};
+
+static inline uint32_t clock_get_hz(enum clock_index clk) {
+    return clk == clk_ref ? 12000000u : 125000000u;
+}
+
+#endif
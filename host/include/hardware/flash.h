@@ -0,0 +1,23 @@
+// HAL de host: flash QSPI simulada em um arquivo (ESTACAO_FLASH_PATH, padrão flash.bin)
+// O arquivo é mapeado em memória e exposto em XIP_BASE como a janela XIP do RP2040;
+// apagar e gravar seguem a semântica NOR (apagar -> 0xFF, gravar só zera bits).
+
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+
+extern uint8_t *host_flash_xip;
+#define XIP_BASE ((uintptr_t)host_flash_xip)
+
+// flash_offs e count múltiplos de FLASH_SECTOR_SIZE
+void flash_range_erase(uint32_t flash_offs, size_t count);
+
+// flash_offs e count múltiplos de FLASH_PAGE_SIZE
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
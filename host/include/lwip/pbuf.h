@@ -0,0 +1,25 @@
+// HAL de host: pbufs encadeados como os entregues pela pilha real
+// Os dados recebidos de um socket são fatiados em pbufs de até HOST_PBUF_CHUNK bytes.
+
+#ifndef HOST_LWIP_PBUF_H
+#define HOST_LWIP_PBUF_H
+
+#include "lwip/arch.h"
+
+#define HOST_PBUF_CHUNK 512
+
+struct pbuf {
+    struct pbuf *next;
+    void *payload;
+    u16_t tot_len;
+    u16_t len;
+    u16_t ref;
+};
+
+u8_t pbuf_free(struct pbuf *p);
+void pbuf_ref(struct pbuf *p);
+void pbuf_cat(struct pbuf *head, struct pbuf *tail);
+struct pbuf *pbuf_free_header(struct pbuf *q, u16_t size);
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset);
+
+#endif
@@ -0,0 +1,33 @@
+// HAL de host: tipos básicos equivalentes ao pico.h do Pico SDK
+// Permite compilar a aplicação e os drivers de lib/ em Linux sem alterações.
+
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// memória flash da Pico W (definida pelo arquivo de placa no Pico SDK)
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+#define _u(x) x ## u
+
+#define __not_in_flash_func(func) func
+#define __time_critical_func(func) func
+
+// códigos de erro retornados pelas funções do SDK
+enum pico_error_codes {
+    PICO_OK = 0,
+    PICO_ERROR_NONE = 0,
+    PICO_ERROR_TIMEOUT = -1,
+    PICO_ERROR_GENERIC = -2,
+    PICO_ERROR_NO_DATA = -3,
+};
+
+// registra uma linha no log da HAL (stderr), prefixada com o tempo desde o boot
+void host_log(const char *subsys, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#endif
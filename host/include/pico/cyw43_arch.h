@@ -0,0 +1,36 @@
+// HAL de host: substituto do pico/cyw43_arch.h
+// Não há rádio: a "conexão" é sempre bem sucedida e a interface recebe 127.0.0.1.
+// A pilha TCP é emulada sobre sockets POSIX (ver lwip_socket.c).
+
+#ifndef HOST_PICO_CYW43_ARCH_H
+#define HOST_PICO_CYW43_ARCH_H
+
+#include "pico.h"
+
+#define CYW43_AUTH_OPEN           0
+#define CYW43_AUTH_WPA_TKIP_PSK   0x00200002
+#define CYW43_AUTH_WPA2_AES_PSK   0x00400004
+#define CYW43_AUTH_WPA2_MIXED_PSK 0x00400006
+
+struct host_netif {
+    struct { uint32_t addr; } ip_addr;
+};
+
+typedef struct {
+    struct host_netif netif[2];
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout);
+
+// processa os eventos pendentes dos sockets e entrega os callbacks tcp_*
+void cyw43_arch_poll(void);
+
+static inline void cyw43_arch_lwip_begin(void) {}
+static inline void cyw43_arch_lwip_end(void) {}
+
+#endif
@@ -0,0 +1,14 @@
+// HAL de host: execução segura de operações de flash
+// No RP2040 o outro núcleo é pausado e as interrupções desligadas enquanto a XIP está
+// indisponível; no host basta serializar os acessos ao arquivo de flash.
+
+#ifndef HOST_PICO_FLASH_H
+#define HOST_PICO_FLASH_H
+
+#include "pico.h"
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+bool flash_safe_execute_core_init(void);
+bool flash_safe_execute_core_deinit(void);
+
+#endif
@@ -0,0 +1,12 @@
+// HAL de host: substituto do pico/stdlib.h do Pico SDK
+
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+bool stdio_init_all(void);
+
+#endif
@@ -0,0 +1,481 @@
+// HAL de host: API raw TCP do lwIP e arquitetura cyw43 sobre sockets POSIX
+// Cada tcp_pcb corresponde a um socket não bloqueante. host_net_service() faz o papel
+// da pilha: aceita conexões, fatia os dados recebidos em pbufs, respeita a janela de
+// recepção (tcp_recved) e o buffer de envio (tcp_sndbuf) e entrega os callbacks.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "pico/cyw43_arch.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "lwip/tcp.h"
+#include "host_hal.h"
+
+// período do temporizador lento do lwIP (base do intervalo de tcp_poll)
+#define HOST_TCP_SLOW_INTERVAL_MS 500
+#define HOST_MAX_PCBS 64
+
+struct tcp_pcb {
+    int fd;
+    bool listening;
+    bool closing;          // tcp_close() chamado: fecha o socket após esvaziar o envio
+    bool peer_closed;      // FIN do cliente já entregue à aplicação
+    bool dead;             // liberado ao fim do ciclo de serviço
+    u16_t port;
+    void *arg;
+    tcp_accept_fn accept;
+    tcp_recv_fn recv;
+    tcp_sent_fn sent;
+    tcp_poll_fn poll;
+    tcp_err_fn errf;
+    u8_t poll_interval;
+    uint64_t next_poll_us;
+    uint8_t snd[TCP_SND_BUF]; // dados enfileirados ainda não aceitos pelo kernel
+    size_t snd_len;
+    u32_t unacked;         // bytes aceitos pelo kernel ainda não reportados via sent
+    u32_t rcv_wnd;         // janela de recepção disponível
+    struct pbuf *refused;  // dados recusados pela aplicação, reentregues depois
+    struct tcp_pcb *next;
+};
+
+const ip_addr_t ip_addr_any = { 0 };
+cyw43_t cyw43_state;
+
+static struct tcp_pcb *pcbs;
+static pthread_t core0_thread;
+static bool net_ready;
+static bool stdin_open = true;
+
+bool host_is_core0(void) {
+    return net_ready && pthread_equal(pthread_self(), core0_thread);
+}
+
+// --- pbufs ---
+static struct pbuf *pbuf_alloc_chain(const uint8_t *data, size_t len) {
+    struct pbuf *head = NULL, **tail = &head;
+    size_t remaining = len;
+    while (remaining > 0) {
+        size_t chunk = remaining < HOST_PBUF_CHUNK ? remaining : HOST_PBUF_CHUNK;
+        struct pbuf *p = malloc(sizeof(struct pbuf) + chunk);
+        if (!p) abort();
+        p->next = NULL;
+        p->payload = (uint8_t *)(p + 1);
+        p->len = (u16_t)chunk;
+        p->tot_len = (u16_t)remaining;
+        p->ref = 1;
+        memcpy(p->payload, data, chunk);
+        data += chunk;
+        remaining -= chunk;
+        *tail = p;
+        tail = &p->next;
+    }
+    return head;
+}
+
+u8_t pbuf_free(struct pbuf *p) {
+    u8_t count = 0;
+    while (p) {
+        if (--p->ref > 0) break;
+        struct pbuf *next = p->next;
+        free(p);
+        count++;
+        p = next;
+    }
+    return count;
+}
+
+void pbuf_ref(struct pbuf *p) {
+    if (p) p->ref++;
+}
+
+void pbuf_cat(struct pbuf *head, struct pbuf *tail) {
+    struct pbuf *p;
+    for (p = head; p->next; p = p->next) {
+        p->tot_len = (u16_t)(p->tot_len + tail->tot_len);
+    }
+    p->tot_len = (u16_t)(p->tot_len + tail->tot_len);
+    p->next = tail;
+}
+
+// descarta os primeiros size bytes da cadeia, liberando os pbufs consumidos por inteiro
+struct pbuf *pbuf_free_header(struct pbuf *q, u16_t size) {
+    while (size > 0 && q) {
+        if (size >= q->len) {
+            struct pbuf *f = q;
+            size = (u16_t)(size - q->len);
+            q = q->next;
+            f->next = NULL;
+            pbuf_free(f);
+        } else {
+            q->payload = (uint8_t *)q->payload + size;
+            q->len = (u16_t)(q->len - size);
+            q->tot_len = (u16_t)(q->tot_len - size);
+            size = 0;
+        }
+    }
+    return q;
+}
+
+u16_t pbuf_copy_partial(const struct pbuf *p, void *dataptr, u16_t len, u16_t offset) {
+    u16_t copied = 0;
+    for (; p && copied < len; p = p->next) {
+        if (offset >= p->len) {
+            offset = (u16_t)(offset - p->len);
+            continue;
+        }
+        u16_t n = (u16_t)(p->len - offset);
+        if (n > len - copied) n = (u16_t)(len - copied);
+        memcpy((uint8_t *)dataptr + copied, (const uint8_t *)p->payload + offset, n);
+        copied = (u16_t)(copied + n);
+        offset = 0;
+    }
+    return copied;
+}
+
+// --- PCBs ---
+struct tcp_pcb *tcp_new(void) {
+    struct tcp_pcb *pcb = calloc(1, sizeof(struct tcp_pcb));
+    if (!pcb) return NULL;
+    pcb->fd = -1;
+    pcb->rcv_wnd = TCP_WND;
+    pcb->next = pcbs;
+    pcbs = pcb;
+    return pcb;
+}
+
+static u16_t host_port(u16_t port) {
+    const char *env = getenv("ESTACAO_HTTP_PORT");
+    if (env && *env) return (u16_t)atoi(env);
+    // portas privilegiadas exigem root no Linux: 80 vira 8080
+    return port < 1024 ? (u16_t)(port + 8000) : port;
+}
+
+err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port) {
+    (void)ipaddr;
+    pcb->port = host_port(port);
+    return ERR_OK;
+}
+
+struct tcp_pcb *tcp_listen(struct tcp_pcb *pcb) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(pcb->port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        host_log("tcp", "falha ao escutar na porta %u: %s", pcb->port, strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    pcb->fd = fd;
+    pcb->listening = true;
+    host_log("tcp", "servidor HTTP em http://127.0.0.1:%u/", pcb->port);
+    return pcb;
+}
+
+void tcp_arg(struct tcp_pcb *pcb, void *arg) { pcb->arg = arg; }
+void tcp_accept(struct tcp_pcb *pcb, tcp_accept_fn accept) { pcb->accept = accept; }
+void tcp_recv(struct tcp_pcb *pcb, tcp_recv_fn recv) { pcb->recv = recv; }
+void tcp_sent(struct tcp_pcb *pcb, tcp_sent_fn sent) { pcb->sent = sent; }
+void tcp_err(struct tcp_pcb *pcb, tcp_err_fn errf) { pcb->errf = errf; }
+void tcp_setprio(struct tcp_pcb *pcb, u8_t prio) { (void)pcb; (void)prio; }
+
+void tcp_poll(struct tcp_pcb *pcb, tcp_poll_fn poll, u8_t interval) {
+    pcb->poll = poll;
+    pcb->poll_interval = interval;
+    pcb->next_poll_us = time_us_64() + (uint64_t)interval * HOST_TCP_SLOW_INTERVAL_MS * 1000u;
+}
+
+void tcp_recved(struct tcp_pcb *pcb, u16_t len) {
+    pcb->rcv_wnd += len;
+    if (pcb->rcv_wnd > TCP_WND) pcb->rcv_wnd = TCP_WND;
+}
+
+u16_t tcp_sndbuf(const struct tcp_pcb *pcb) {
+    return (u16_t)(TCP_SND_BUF - pcb->snd_len - pcb->unacked);
+}
+
+u16_t tcp_sndqueuelen(const struct tcp_pcb *pcb) {
+    return (u16_t)((pcb->snd_len + TCP_MSS - 1) / TCP_MSS);
+}
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags) {
+    (void)apiflags; // sem a flag de cópia a pilha real referencia os dados; aqui sempre copiamos
+    if (pcb->dead || pcb->closing || pcb->listening) return ERR_CONN;
+    if (len > tcp_sndbuf(pcb)) return ERR_MEM;
+    memcpy(pcb->snd + pcb->snd_len, dataptr, len);
+    pcb->snd_len += len;
+    return ERR_OK;
+}
+
+err_t tcp_output(struct tcp_pcb *pcb) {
+    if (pcb->fd < 0 || pcb->snd_len == 0) return ERR_OK;
+    ssize_t n = send(pcb->fd, pcb->snd, pcb->snd_len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? ERR_OK : ERR_CONN;
+    }
+    memmove(pcb->snd, pcb->snd + n, pcb->snd_len - (size_t)n);
+    pcb->snd_len -= (size_t)n;
+    // o kernel assumiu os bytes: tratados como confirmados no próximo ciclo de serviço
+    pcb->unacked += (u32_t)n;
+    return ERR_OK;
+}
+
+static void pcb_release_fd(struct tcp_pcb *pcb, bool reset) {
+    if (pcb->fd >= 0) {
+        if (reset) {
+            struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+            setsockopt(pcb->fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+        }
+        close(pcb->fd);
+        pcb->fd = -1;
+    }
+    if (pcb->refused) {
+        pbuf_free(pcb->refused);
+        pcb->refused = NULL;
+    }
+}
+
+err_t tcp_close(struct tcp_pcb *pcb) {
+    if (pcb->listening || pcb->fd < 0) {
+        pcb_release_fd(pcb, false);
+        pcb->dead = true;
+        return ERR_OK;
+    }
+    pcb->closing = true;
+    tcp_output(pcb);
+    return ERR_OK;
+}
+
+void tcp_abort(struct tcp_pcb *pcb) {
+    if (pcb->dead) return;
+    pcb_release_fd(pcb, true);
+    pcb->dead = true;
+    if (pcb->errf) pcb->errf(pcb->arg, ERR_ABRT);
+}
+
+// erro fatal no socket: a pilha libera o pcb e avisa a aplicação
+static void pcb_fail(struct tcp_pcb *pcb, err_t err) {
+    pcb_release_fd(pcb, true);
+    pcb->dead = true;
+    if (pcb->errf) pcb->errf(pcb->arg, err);
+}
+
+// --- Serviço da pilha ---
+static void deliver_recv(struct tcp_pcb *pcb, struct pbuf *p) {
+    if (!pcb->recv) {
+        // comportamento de tcp_recv_null: descarta os dados e fecha ao receber FIN
+        if (p) {
+            tcp_recved(pcb, p->tot_len);
+            pbuf_free(p);
+        } else {
+            tcp_close(pcb);
+        }
+        return;
+    }
+    err_t err = pcb->recv(pcb->arg, pcb, p, ERR_OK);
+    if (err != ERR_OK && err != ERR_ABRT && p && !pcb->dead) {
+        pcb->refused = p; // a aplicação não pôde tratar agora: reentrega no próximo ciclo
+    }
+}
+
+static void service_accept(struct tcp_pcb *lpcb) {
+    for (;;) {
+        int fd = accept(lpcb->fd, NULL, NULL);
+        if (fd < 0) return;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        struct tcp_pcb *pcb = tcp_new();
+        if (!pcb) {
+            close(fd);
+            return;
+        }
+        pcb->fd = fd;
+        pcb->port = lpcb->port;
+        pcb->arg = lpcb->arg;
+        err_t err = lpcb->accept ? lpcb->accept(lpcb->arg, pcb, ERR_OK) : ERR_VAL;
+        if (err != ERR_OK && err != ERR_ABRT && !pcb->dead) {
+            tcp_abort(pcb);
+        }
+    }
+}
+
+static void service_read(struct tcp_pcb *pcb) {
+    uint8_t buf[4096];
+    size_t want = pcb->rcv_wnd < sizeof(buf) ? pcb->rcv_wnd : sizeof(buf);
+    ssize_t n = recv(pcb->fd, buf, want, MSG_DONTWAIT);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) pcb_fail(pcb, ERR_RST);
+        return;
+    }
+    if (n == 0) {
+        pcb->peer_closed = true;
+        deliver_recv(pcb, NULL);
+        return;
+    }
+    pcb->rcv_wnd -= (u32_t)n;
+    deliver_recv(pcb, pbuf_alloc_chain(buf, (size_t)n));
+}
+
+static void service_stdin(void) {
+    char keys[64];
+    ssize_t n = read(STDIN_FILENO, keys, sizeof(keys));
+    if (n <= 0) {
+        stdin_open = false;
+        return;
+    }
+    for (ssize_t i = 0; i < n; i++) host_gpio_key(keys[i]);
+}
+
+static void service_timers(struct tcp_pcb *pcb, uint64_t now) {
+    if (pcb->dead) return;
+    // confirmações: libera o espaço de envio e avisa a aplicação
+    while (pcb->unacked > 0 && !pcb->closing && !pcb->dead) {
+        u16_t len = pcb->unacked > 0xFFFF ? 0xFFFF : (u16_t)pcb->unacked;
+        pcb->unacked -= len;
+        if (pcb->sent) pcb->sent(pcb->arg, pcb, len);
+    }
+    if (pcb->closing) pcb->unacked = 0;
+
+    if (!pcb->dead && pcb->refused && !pcb->closing) {
+        struct pbuf *p = pcb->refused;
+        pcb->refused = NULL;
+        deliver_recv(pcb, p);
+    }
+    if (!pcb->dead && pcb->poll && pcb->poll_interval && !pcb->closing && now >= pcb->next_poll_us) {
+        pcb->next_poll_us = now + (uint64_t)pcb->poll_interval * HOST_TCP_SLOW_INTERVAL_MS * 1000u;
+        pcb->poll(pcb->arg, pcb);
+    }
+    if (!pcb->dead && pcb->closing && pcb->snd_len == 0) {
+        shutdown(pcb->fd, SHUT_WR);
+        pcb_release_fd(pcb, false);
+        pcb->dead = true;
+    }
+}
+
+static void sweep_dead(void) {
+    struct tcp_pcb **pp = &pcbs;
+    while (*pp) {
+        struct tcp_pcb *pcb = *pp;
+        if (pcb->dead) {
+            *pp = pcb->next;
+            free(pcb);
+        } else {
+            pp = &pcb->next;
+        }
+    }
+}
+
+void host_net_service(int timeout_ms) {
+    struct pollfd fds[HOST_MAX_PCBS + 1];
+    struct tcp_pcb *owners[HOST_MAX_PCBS + 1];
+    nfds_t nfds = 0;
+    bool pending = false;
+
+    host_pio_latch();
+
+    for (struct tcp_pcb *pcb = pcbs; pcb && nfds < HOST_MAX_PCBS; pcb = pcb->next) {
+        if (pcb->dead || pcb->fd < 0) continue;
+        short events = 0;
+        if (pcb->listening) {
+            events = POLLIN;
+        } else {
+            if (pcb->rcv_wnd > 0 && !pcb->closing && !pcb->peer_closed && !pcb->refused) events |= POLLIN;
+            if (pcb->snd_len > 0) events |= POLLOUT;
+            if (pcb->unacked > 0 || pcb->refused || (pcb->closing && pcb->snd_len == 0)) pending = true;
+        }
+        fds[nfds].fd = pcb->fd;
+        fds[nfds].events = events;
+        fds[nfds].revents = 0;
+        owners[nfds++] = pcb;
+    }
+    if (stdin_open) {
+        fds[nfds].fd = STDIN_FILENO;
+        fds[nfds].events = POLLIN;
+        fds[nfds].revents = 0;
+        owners[nfds++] = NULL;
+    }
+
+    // o próximo tcp_poll limita a espera
+    uint64_t now = time_us_64();
+    for (struct tcp_pcb *pcb = pcbs; pcb; pcb = pcb->next) {
+        if (pcb->dead || !pcb->poll || !pcb->poll_interval) continue;
+        int until = pcb->next_poll_us > now ? (int)((pcb->next_poll_us - now) / 1000u) : 0;
+        if (until < timeout_ms) timeout_ms = until;
+    }
+
+    int ready = poll(fds, nfds, pending ? 0 : timeout_ms);
+    for (nfds_t i = 0; ready > 0 && i < nfds; i++) {
+        if (!fds[i].revents) continue;
+        struct tcp_pcb *pcb = owners[i];
+        if (!pcb) {
+            service_stdin();
+            continue;
+        }
+        if (pcb->dead) continue;
+        if (pcb->listening) {
+            service_accept(pcb);
+            continue;
+        }
+        if (fds[i].revents & POLLOUT) tcp_output(pcb);
+        if (!pcb->dead && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+            if (pcb->closing || pcb->peer_closed || pcb->refused || pcb->rcv_wnd == 0) {
+                if (fds[i].revents & POLLERR) pcb_fail(pcb, ERR_RST);
+            } else {
+                service_read(pcb);
+            }
+        }
+    }
+
+    now = time_us_64();
+    for (struct tcp_pcb *pcb = pcbs; pcb; pcb = pcb->next) {
+        service_timers(pcb, now);
+    }
+    sweep_dead();
+}
+
+// --- cyw43 ---
+int cyw43_arch_init(void) {
+    signal(SIGPIPE, SIG_IGN);
+    core0_thread = pthread_self();
+    net_ready = true;
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+    net_ready = false;
+}
+
+void cyw43_arch_enable_sta_mode(void) {}
+
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout) {
+    (void)pw;
+    (void)auth;
+    (void)timeout;
+    cyw43_state.netif[0].ip_addr.addr = htonl(INADDR_LOOPBACK);
+    host_log("cyw43", "conectado a \"%s\" (simulado)", ssid);
+    return 0;
+}
+
+void cyw43_arch_poll(void) {
+    host_net_service(0);
+}
@@ -0,0 +1,522 @@
+// HAL de host: barramentos I2C com modelos de registradores dos dispositivos da placa
+// - AHT20 (i2c0, 0x38): comandos de inicialização, disparo e reset, bit de ocupado
+//   durante a conversão de ~80 ms e 6 bytes de dados + CRC.
+// - BMP280 (i2c0, 0x76): mapa de registradores com chip id, calibração (valores de
+//   exemplo do datasheet), ctrl_meas/config, status e registradores de dados. As leituras
+//   brutas são obtidas invertendo a compensação do datasheet a partir do ambiente simulado.
+// - SSD1306 (i2c1, 0x3C): interpretador de comandos e GDDRAM; cada quadro recebido é
+//   gravado como imagem PBM em ESTACAO_FB_PATH (padrão: ssd1306.pbm).
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/time.h"
+#include "hardware/i2c.h"
+#include "host_hal.h"
+
+struct i2c_inst {
+    uint index;
+    uint baudrate;
+    i2c_hw_t *hw;
+};
+
+static i2c_hw_t i2c0_hw = { .status = I2C_IC_STATUS_TFE_BITS };
+static i2c_hw_t i2c1_hw = { .status = I2C_IC_STATUS_TFE_BITS };
+
+i2c_inst_t i2c0_inst = { 0, 0, &i2c0_hw };
+i2c_inst_t i2c1_inst = { 1, 0, &i2c1_hw };
+
+// --- Ambiente simulado ---
+// ciclos lentos que atravessam os limites de alerta padrão da aplicação
+static uint32_t noise_state;
+
+static double sim_noise(void) {
+    if (noise_state == 0) {
+        const char *seed = getenv("ESTACAO_SIM_SEED");
+        noise_state = seed ? (uint32_t)strtoul(seed, NULL, 0) | 1u : 0x2545F491u;
+    }
+    // xorshift32 mapeado para [-1, 1)
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    return (double)noise_state / 2147483648.0 - 1.0;
+}
+
+// picos isolados de +-amplitude com a probabilidade de ESTACAO_SIM_SPIKES por leitura
+// (padrão 0), para exercitar a rejeição de picos do estágio de filtragem
+static double sim_spike(double amplitude) {
+    static double probability = -1.0;
+    if (probability < 0) {
+        const char *env = getenv("ESTACAO_SIM_SPIKES");
+        probability = env ? atof(env) : 0.0;
+    }
+    if (probability <= 0 || (sim_noise() + 1.0) / 2.0 >= probability) return 0.0;
+    return sim_noise() < 0 ? -amplitude : amplitude;
+}
+
+static double sim_seconds(void) {
+    return (double)time_us_64() / 1e6;
+}
+
+static double env_temperature(void) {
+    return 27.0 + 15.0 * sin(2.0 * M_PI * sim_seconds() / 600.0);     // °C
+}
+
+static double env_humidity(void) {
+    return 50.0 + 25.0 * sin(2.0 * M_PI * sim_seconds() / 900.0);     // %
+}
+
+static double env_pressure(void) {
+    return 100000.0 + 3000.0 * sin(2.0 * M_PI * sim_seconds() / 1200.0); // Pa
+}
+
+// --- AHT20 ---
+#define AHT20_ADDR 0x38
+#define AHT20_CONVERSION_US 80000
+
+static struct {
+    bool calibrated;
+    bool measuring;
+    uint64_t ready_at_us;
+    uint8_t data[6];
+} aht20;
+
+static uint8_t aht20_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void aht20_latch_measurement(void) {
+    double h = env_humidity() + 0.3 * sim_noise() + sim_spike(10.0);
+    double t = env_temperature() + 0.05 * sim_noise();
+    if (h < 0) h = 0;
+    if (h > 100) h = 100;
+    uint32_t raw_h = (uint32_t)(h / 100.0 * 1048576.0);
+    uint32_t raw_t = (uint32_t)((t + 50.0) / 200.0 * 1048576.0);
+    if (raw_h > 0xFFFFF) raw_h = 0xFFFFF;
+    if (raw_t > 0xFFFFF) raw_t = 0xFFFFF;
+    aht20.data[1] = (uint8_t)(raw_h >> 12);
+    aht20.data[2] = (uint8_t)(raw_h >> 4);
+    aht20.data[3] = (uint8_t)(((raw_h & 0x0F) << 4) | (raw_t >> 16));
+    aht20.data[4] = (uint8_t)(raw_t >> 8);
+    aht20.data[5] = (uint8_t)raw_t;
+}
+
+static uint8_t aht20_status(void) {
+    if (aht20.measuring && time_us_64() >= aht20.ready_at_us) {
+        aht20.measuring = false;
+        aht20_latch_measurement();
+    }
+    return (uint8_t)((aht20.measuring ? 0x80 : 0x00) | (aht20.calibrated ? 0x18 : 0x10));
+}
+
+static int aht20_write(const uint8_t *src, size_t len) {
+    if (len == 0) return 0;
+    switch (src[0]) {
+        case 0xBE: // inicialização/calibração
+            aht20.calibrated = true;
+            break;
+        case 0xAC: // disparo de medição
+            if (len >= 3 && src[1] == 0x33) {
+                aht20.measuring = true;
+                aht20.ready_at_us = time_us_64() + AHT20_CONVERSION_US;
+            }
+            break;
+        case 0xBA: // reset por software
+            aht20.measuring = false;
+            aht20.calibrated = false;
+            break;
+    }
+    return (int)len;
+}
+
+static int aht20_read(uint8_t *dst, size_t len) {
+    uint8_t frame[7];
+    frame[0] = aht20_status();
+    memcpy(frame + 1, aht20.data + 1, 5);
+    frame[6] = aht20_crc8(frame, 6);
+    for (size_t i = 0; i < len; i++) dst[i] = i < sizeof(frame) ? frame[i] : 0xFF;
+    return (int)len;
+}
+
+// --- BMP280 ---
+#define BMP280_ADDR 0x76
+
+static const struct {
+    uint16_t t1; int16_t t2, t3;
+    uint16_t p1; int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+} bmp_calib = { 27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000 };
+
+static struct {
+    uint8_t regs[256];
+    uint8_t pointer;
+    bool measuring;
+    uint64_t ready_at_us;
+    uint64_t next_normal_us;
+    double filt_t, filt_p;
+    bool filt_valid;
+} bmp;
+
+// compensação em ponto flutuante do datasheet (seção 8.1), usada para inverter as leituras
+static double bmp_comp_t(int32_t adc_t, double *t_fine) {
+    double v1 = ((double)adc_t / 16384.0 - (double)bmp_calib.t1 / 1024.0) * (double)bmp_calib.t2;
+    double v2 = ((double)adc_t / 131072.0 - (double)bmp_calib.t1 / 8192.0);
+    v2 = v2 * v2 * (double)bmp_calib.t3;
+    *t_fine = v1 + v2;
+    return (v1 + v2) / 5120.0;
+}
+
+static double bmp_comp_p(int32_t adc_p, double t_fine) {
+    double v1 = t_fine / 2.0 - 64000.0;
+    double v2 = v1 * v1 * (double)bmp_calib.p6 / 32768.0;
+    v2 = v2 + v1 * (double)bmp_calib.p5 * 2.0;
+    v2 = v2 / 4.0 + (double)bmp_calib.p4 * 65536.0;
+    v1 = ((double)bmp_calib.p3 * v1 * v1 / 524288.0 + (double)bmp_calib.p2 * v1) / 524288.0;
+    v1 = (1.0 + v1 / 32768.0) * (double)bmp_calib.p1;
+    if (v1 == 0.0) return 0;
+    double p = 1048576.0 - (double)adc_p;
+    p = (p - v2 / 4096.0) * 6250.0 / v1;
+    v1 = (double)bmp_calib.p9 * p * p / 2147483648.0;
+    v2 = p * (double)bmp_calib.p8 / 32768.0;
+    return p + (v1 + v2 + (double)bmp_calib.p7) / 16.0;
+}
+
+static uint8_t bmp_osrs_count(uint8_t osrs) {
+    static const uint8_t counts[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+    return counts[osrs & 7];
+}
+
+static void bmp_store20(uint8_t reg, uint32_t raw) {
+    bmp.regs[reg] = (uint8_t)(raw >> 12);
+    bmp.regs[reg + 1] = (uint8_t)(raw >> 4);
+    bmp.regs[reg + 2] = (uint8_t)((raw & 0x0F) << 4);
+}
+
+static void bmp_latch_measurement(void) {
+    uint8_t ctrl = bmp.regs[0xF4];
+    uint8_t osrs_t = bmp_osrs_count(ctrl >> 5), osrs_p = bmp_osrs_count(ctrl >> 2);
+    double t = env_temperature(), p = env_pressure();
+
+    // ruído reduz com a sobreamostragem; o filtro IIR suaviza as conversões sucessivas
+    if (osrs_t) t += 0.02 * sim_noise() / sqrt(osrs_t);
+    if (osrs_p) p += 6.0 * sim_noise() / sqrt(osrs_p);
+    p += sim_spike(500.0);
+    uint8_t coef = (uint8_t)((bmp.regs[0xF5] >> 2) & 7);
+    if (coef && bmp.filt_valid) {
+        double k = (double)(1u << (coef > 4 ? 4 : coef));
+        bmp.filt_t = (bmp.filt_t * (k - 1.0) + t) / k;
+        bmp.filt_p = (bmp.filt_p * (k - 1.0) + p) / k;
+    } else {
+        bmp.filt_t = t;
+        bmp.filt_p = p;
+        bmp.filt_valid = true;
+    }
+
+    // busca binária: temperatura cresce e pressão decresce com o valor bruto
+    int32_t lo = 0, hi = 0xFFFFF;
+    double t_fine = 0;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+        if (bmp_comp_t(mid, &t_fine) < bmp.filt_t) lo = mid + 1; else hi = mid;
+    }
+    int32_t adc_t = lo;
+    bmp_comp_t(adc_t, &t_fine);
+    lo = 0;
+    hi = 0xFFFFF;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+        if (bmp_comp_p(mid, t_fine) > bmp.filt_p) lo = mid + 1; else hi = mid;
+    }
+    bmp_store20(0xF7, osrs_p ? (uint32_t)lo : 0x80000);
+    bmp_store20(0xFA, osrs_t ? (uint32_t)adc_t : 0x80000);
+}
+
+static uint64_t bmp_measure_time_us(void) {
+    uint8_t ctrl = bmp.regs[0xF4];
+    // tempo típico de conversão (datasheet, seção 3.8.1)
+    return 1000u + 2000u * bmp_osrs_count(ctrl >> 5) + 2000u * bmp_osrs_count(ctrl >> 2) + 500u;
+}
+
+static uint64_t bmp_standby_us(void) {
+    static const uint32_t standby[8] = { 500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000 };
+    return standby[bmp.regs[0xF5] >> 5];
+}
+
+static void bmp_reset(void) {
+    memset(bmp.regs, 0, sizeof(bmp.regs));
+    bmp.regs[0xD0] = 0x58;
+    const uint16_t words[12] = {
+        bmp_calib.t1, (uint16_t)bmp_calib.t2, (uint16_t)bmp_calib.t3,
+        bmp_calib.p1, (uint16_t)bmp_calib.p2, (uint16_t)bmp_calib.p3, (uint16_t)bmp_calib.p4,
+        (uint16_t)bmp_calib.p5, (uint16_t)bmp_calib.p6, (uint16_t)bmp_calib.p7,
+        (uint16_t)bmp_calib.p8, (uint16_t)bmp_calib.p9,
+    };
+    for (int i = 0; i < 12; i++) {
+        bmp.regs[0x88 + 2 * i] = (uint8_t)words[i];
+        bmp.regs[0x89 + 2 * i] = (uint8_t)(words[i] >> 8);
+    }
+    bmp_store20(0xF7, 0x80000);
+    bmp_store20(0xFA, 0x80000);
+    bmp.measuring = false;
+    bmp.filt_valid = false;
+}
+
+// avança as conversões conforme o modo atual (sleep, forced ou normal)
+static void bmp_update(void) {
+    uint64_t now = time_us_64();
+    uint8_t mode = bmp.regs[0xF4] & 3;
+    if (bmp.measuring && now >= bmp.ready_at_us) {
+        bmp.measuring = false;
+        bmp_latch_measurement();
+        if (mode == 1 || mode == 2) bmp.regs[0xF4] &= (uint8_t)~3; // forced volta a sleep
+    }
+    if (mode == 3 && !bmp.measuring && now >= bmp.next_normal_us) {
+        bmp.measuring = true;
+        bmp.ready_at_us = now + bmp_measure_time_us();
+        bmp.next_normal_us = bmp.ready_at_us + bmp_standby_us();
+    }
+    bmp.regs[0xF3] = bmp.measuring ? 0x08 : 0x00;
+}
+
+static void bmp_write_reg(uint8_t reg, uint8_t value) {
+    switch (reg) {
+        case 0xE0:
+            if (value == 0xB6) bmp_reset();
+            break;
+        case 0xF4:
+            bmp.regs[0xF4] = value;
+            if ((value & 3) == 1 || (value & 3) == 2) {
+                bmp.measuring = true;
+                bmp.ready_at_us = time_us_64() + bmp_measure_time_us();
+            } else if ((value & 3) == 3) {
+                bmp.next_normal_us = time_us_64();
+            }
+            break;
+        case 0xF5:
+            bmp.regs[0xF5] = value;
+            break;
+    }
+}
+
+static int bmp_write(const uint8_t *src, size_t len) {
+    // escrita em pares (registrador, valor), sem autoincremento; um byte
+    // isolado apenas posiciona o ponteiro para a leitura seguinte
+    size_t i = 0;
+    for (; i + 1 < len; i += 2) {
+        bmp_write_reg(src[i], src[i + 1]);
+        bmp.pointer = src[i];
+    }
+    if (i < len) bmp.pointer = src[i];
+    bmp_update();
+    return (int)len;
+}
+
+static int bmp_read(uint8_t *dst, size_t len) {
+    bmp_update();
+    for (size_t i = 0; i < len; i++) dst[i] = bmp.regs[(uint8_t)(bmp.pointer + i)];
+    return (int)len;
+}
+
+// --- SSD1306 ---
+#define SSD1306_ADDR 0x3C
+#define SSD_W 128
+#define SSD_PAGES 8
+
+static struct {
+    uint8_t gddram[SSD_PAGES][SSD_W];
+    uint8_t shown[SSD_PAGES][SSD_W];
+    uint8_t addr_mode;             // 0: horizontal, 1: vertical, 2: página
+    uint8_t col_start, col_end, col;
+    uint8_t page_start, page_end, page;
+    uint8_t cmd[3];                // comando multibyte em andamento
+    uint8_t cmd_len, cmd_need;
+    bool display_on;
+    bool dirty;
+} ssd = { .addr_mode = 2, .col_end = SSD_W - 1, .page_end = SSD_PAGES - 1 };
+
+static uint8_t ssd_cmd_args(uint8_t c) {
+    switch (c) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5:
+        case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+static void ssd_exec_command(void) {
+    uint8_t c = ssd.cmd[0];
+    switch (c) {
+        case 0x20: ssd.addr_mode = ssd.cmd[1] & 3; break;
+        case 0x21:
+            ssd.col_start = ssd.col = ssd.cmd[1] & 0x7F;
+            ssd.col_end = ssd.cmd[2] & 0x7F;
+            break;
+        case 0x22:
+            ssd.page_start = ssd.page = ssd.cmd[1] & 7;
+            ssd.page_end = ssd.cmd[2] & 7;
+            break;
+        case 0xAE: ssd.display_on = false; break;
+        case 0xAF: ssd.display_on = true; break;
+        default:
+            if (c >= 0xB0 && c <= 0xB7) ssd.page = c & 7;
+            break;
+    }
+}
+
+static void ssd_command_byte(uint8_t b) {
+    if (ssd.cmd_len == 0) ssd.cmd_need = (uint8_t)(1 + ssd_cmd_args(b));
+    ssd.cmd[ssd.cmd_len++] = b;
+    if (ssd.cmd_len == ssd.cmd_need) {
+        ssd_exec_command();
+        ssd.cmd_len = 0;
+    }
+}
+
+static void ssd_data_byte(uint8_t b) {
+    ssd.gddram[ssd.page][ssd.col] = b;
+    ssd.dirty = true;
+    if (ssd.addr_mode == 1) {
+        // vertical: percorre as páginas e depois avança a coluna
+        if (ssd.page >= ssd.page_end) {
+            ssd.page = ssd.page_start;
+            ssd.col = ssd.col >= ssd.col_end ? ssd.col_start : (uint8_t)(ssd.col + 1);
+        } else {
+            ssd.page++;
+        }
+    } else {
+        if (ssd.col >= ssd.col_end) {
+            ssd.col = ssd.col_start;
+            if (ssd.addr_mode == 0) ssd.page = ssd.page >= ssd.page_end ? ssd.page_start : (uint8_t)(ssd.page + 1);
+        } else {
+            ssd.col++;
+        }
+    }
+}
+
+static void ssd_dump_frame(void) {
+    if (!ssd.dirty || memcmp(ssd.gddram, ssd.shown, sizeof(ssd.shown)) == 0) {
+        ssd.dirty = false;
+        return;
+    }
+    ssd.dirty = false;
+    memcpy(ssd.shown, ssd.gddram, sizeof(ssd.shown));
+
+    const char *path = getenv("ESTACAO_FB_PATH");
+    if (!path) path = "ssd1306.pbm";
+    if (!*path) return;
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return;
+    fprintf(f, "P1\n%d %d\n", SSD_W, SSD_PAGES * 8);
+    for (int y = 0; y < SSD_PAGES * 8; y++) {
+        for (int x = 0; x < SSD_W; x++) {
+            fputc((ssd.shown[y >> 3][x] >> (y & 7)) & 1 ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+    rename(tmp, path);
+}
+
+static int ssd_write(const uint8_t *src, size_t len) {
+    size_t i = 0;
+    // cada bloco começa com um byte de controle: Co (bit 7) e D/C# (bit 6)
+    while (i < len) {
+        uint8_t control = src[i++];
+        bool data = control & 0x40;
+        bool single = control & 0x80;
+        if (single) {
+            if (i < len) {
+                if (data) ssd_data_byte(src[i]); else ssd_command_byte(src[i]);
+                i++;
+            }
+            continue;
+        }
+        for (; i < len; i++) {
+            if (data) ssd_data_byte(src[i]); else ssd_command_byte(src[i]);
+        }
+    }
+    ssd_dump_frame();
+    return (int)len;
+}
+
+// --- Barramento ---
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    if (i2c->index == 0) bmp_reset();
+    return baudrate;
+}
+
+// tempo de barramento aproximado: 9 bits por byte mais endereço
+static uint64_t i2c_transfer_us(i2c_inst_t *i2c, size_t len) {
+    if (i2c->baudrate == 0) return 0;
+    return (uint64_t)(len + 1) * 9u * 1000000u / i2c->baudrate;
+}
+
+static void i2c_bus_time(i2c_inst_t *i2c, size_t len) {
+    uint64_t end = time_us_64() + i2c_transfer_us(i2c, len);
+    while (time_us_64() < end) {
+    }
+}
+
+static int i2c_deliver(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len) {
+    if (i2c->index == 0 && addr == AHT20_ADDR) return aht20_write(src, len);
+    if (i2c->index == 0 && addr == BMP280_ADDR) return bmp_write(src, len);
+    if (i2c->index == 1 && addr == SSD1306_ADDR) return ssd_write(src, len);
+    return PICO_ERROR_GENERIC;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)nostop;
+    i2c_bus_time(i2c, len);
+    return i2c_deliver(i2c, addr, src, len);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)nostop;
+    i2c_bus_time(i2c, len);
+    if (i2c->index == 0 && addr == AHT20_ADDR) return aht20_read(dst, len);
+    if (i2c->index == 0 && addr == BMP280_ADDR) return bmp_read(dst, len);
+    return PICO_ERROR_GENERIC;
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+    return i2c->hw;
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) {
+    // numeração do RP2040: DREQ_I2C0_TX = 32, DREQ_I2C0_RX = 33, DREQ_I2C1_TX = 34...
+    return 32u + 2u * i2c->index + (is_tx ? 0u : 1u);
+}
+
+int64_t host_i2c_dma_write(volatile void *write_addr, const uint16_t *words, size_t count) {
+    i2c_inst_t *i2c;
+    if (write_addr == &i2c0_hw.data_cmd) i2c = &i2c0_inst;
+    else if (write_addr == &i2c1_hw.data_cmd) i2c = &i2c1_inst;
+    else return -1;
+
+    // uma transação por bit de STOP; o byte de dados está nos 8 bits de baixo de cada palavra
+    static uint8_t bytes[2048];
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (len < sizeof(bytes)) bytes[len++] = (uint8_t)words[i];
+        if ((words[i] & I2C_IC_DATA_CMD_STOP_BITS) || i + 1 == count) {
+            // sem ACK o controlador abortaria a transação; aqui só fica registrado
+            if (i2c_deliver(i2c, (uint8_t)i2c->hw->tar, bytes, len) < 0) {
+                host_log("i2c", "i2c%u: DMA para 0x%02x sem resposta", i2c->index, (unsigned)i2c->hw->tar);
+            }
+            len = 0;
+        }
+    }
+    return (int64_t)i2c_transfer_us(i2c, count);
+}
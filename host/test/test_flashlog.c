@@ -0,0 +1,159 @@
+// Teste de host do registro na flash (lib/flashlog.c) contra a flash simulada em arquivo
+// (host/flash_host.c): acréscimo e leitura, recuperação da cabeça no boot, volta pelos
+// setores e página gravada pela metade. Registrado no ctest; retorna 1 na primeira falha.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flashlog.h"
+#include "hardware/flash.h"
+
+#define REGIAO_OFFSET 0
+#define REGIAO_SETORES 3                // mínimo aceito: força a volta pelos setores
+#define REGIAO_TAMANHO (REGIAO_SETORES * FLASHLOG_SECTOR_SIZE)
+#define TAMANHO_REGISTRO 12             // history_record_t
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                         \
+        }                                                                    \
+    } while (0)
+
+static void apagar_regiao(void) {
+    flash_range_erase(REGIAO_OFFSET, REGIAO_TAMANHO);
+}
+
+// valor do registro i da página seq: identifica a posição de cada registro no log
+static uint32_t valor(const flashlog_t *log, uint32_t seq, uint32_t i) {
+    return seq * log->records_per_page + i;
+}
+
+// completa e grava n páginas a partir da cabeça
+static void gravar_paginas(flashlog_t *log, uint32_t n) {
+    for (uint32_t p = 0; p < n; p++) {
+        uint32_t seq = log->head;
+        for (uint32_t i = 0; i < log->records_per_page; i++) {
+            uint8_t registro[TAMANHO_REGISTRO] = { 0 };
+            uint32_t v = valor(log, seq, i);
+            memcpy(registro, &v, sizeof(v));
+            CHECK(flashlog_append(log, registro));
+        }
+        while (flashlog_task(log)) {
+        }
+        CHECK(log->head == seq + 1);
+    }
+}
+
+static void conferir_pagina(const flashlog_t *log, uint32_t seq, uint16_t boot) {
+    const flashlog_page_t *page = flashlog_page(log, seq);
+    CHECK(page != NULL);
+    CHECK(page->seq == seq);
+    CHECK(page->boot == boot);
+    for (uint32_t i = 0; i < log->records_per_page; i++) {
+        uint32_t v;
+        memcpy(&v, page->payload + i * TAMANHO_REGISTRO, sizeof(v));
+        CHECK(v == valor(log, seq, i));
+    }
+}
+
+static void teste_regiao_invalida(void) {
+    flashlog_t log;
+    CHECK(!flashlog_init(&log, REGIAO_OFFSET + 1, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    CHECK(!flashlog_init(&log, REGIAO_OFFSET, 2 * FLASHLOG_SECTOR_SIZE, TAMANHO_REGISTRO));
+    CHECK(!flashlog_init(&log, REGIAO_OFFSET, REGIAO_TAMANHO, FLASHLOG_PAYLOAD_SIZE + 1));
+}
+
+static void teste_acrescimo_e_recuperacao(void) {
+    apagar_regiao();
+    flashlog_t log;
+    CHECK(flashlog_init(&log, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    CHECK(log.head == 0 && log.boot == 1);
+    CHECK(flashlog_page(&log, 0) == NULL);
+
+    gravar_paginas(&log, 5);
+    for (uint32_t seq = 0; seq < 5; seq++) conferir_pagina(&log, seq, 1);
+    CHECK(flashlog_page(&log, 5) == NULL);
+
+    // página cheia ainda não gravada: o acréscimo seguinte é descartado e contado
+    uint8_t registro[TAMANHO_REGISTRO] = { 0 };
+    for (uint32_t i = 0; i < log.records_per_page; i++) CHECK(flashlog_append(&log, registro));
+    CHECK(!flashlog_append(&log, registro));
+    CHECK(log.dropped == 1);
+
+    // novo boot sem gravar a página em RAM: ela se perde, o resto é recuperado
+    flashlog_t reboot;
+    CHECK(flashlog_init(&reboot, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    CHECK(reboot.head == 5 && reboot.boot == 2);
+    for (uint32_t seq = 0; seq < 5; seq++) conferir_pagina(&reboot, seq, 1);
+
+    gravar_paginas(&reboot, 2);
+    conferir_pagina(&reboot, 5, 2);
+    conferir_pagina(&reboot, 6, 2);
+}
+
+static void teste_volta_pelos_setores(void) {
+    apagar_regiao();
+    flashlog_t log;
+    CHECK(flashlog_init(&log, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+
+    // mais de duas voltas pela região, terminando no meio de um setor
+    uint32_t total = 2 * REGIAO_SETORES * FLASHLOG_PAGES_PER_SECTOR + 7;
+    gravar_paginas(&log, total);
+    uint32_t primeira = flashlog_first_seq(&log);
+    CHECK(primeira > 0);
+    CHECK(total - primeira >= (REGIAO_SETORES - 2) * FLASHLOG_PAGES_PER_SECTOR);
+    CHECK(flashlog_page(&log, primeira - 1) == NULL);
+    for (uint32_t seq = primeira; seq < total; seq++) conferir_pagina(&log, seq, 1);
+
+    // a cabeça é recuperada depois da volta, inclusive exatamente no início de um setor
+    flashlog_t reboot;
+    CHECK(flashlog_init(&reboot, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    CHECK(reboot.head == total && reboot.boot == 2);
+    CHECK(flashlog_first_seq(&reboot) == primeira);
+    gravar_paginas(&reboot, FLASHLOG_PAGES_PER_SECTOR - 7);
+    CHECK(reboot.head % FLASHLOG_PAGES_PER_SECTOR == 0);
+
+    flashlog_t reboot2;
+    CHECK(flashlog_init(&reboot2, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    CHECK(reboot2.head == reboot.head && reboot2.boot == 3);
+    gravar_paginas(&reboot2, 1);
+    conferir_pagina(&reboot2, reboot.head, 3);
+    conferir_pagina(&reboot2, reboot.head - 1, 2);
+}
+
+static void teste_pagina_interrompida(void) {
+    apagar_regiao();
+    flashlog_t log;
+    CHECK(flashlog_init(&log, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    gravar_paginas(&log, 3);
+
+    // queda de energia durante a gravação da página 3: cabeçalho gravado, payload incompleto
+    flashlog_page_t rasgada;
+    memset(&rasgada, 0xFF, sizeof(rasgada));
+    rasgada.seq = 3;
+    rasgada.boot = log.boot;
+    rasgada.crc = 0x1234;
+    memset(rasgada.payload, 0, FLASHLOG_PAYLOAD_SIZE / 2);
+    flash_range_program(REGIAO_OFFSET + 3 * FLASHLOG_PAGE_SIZE, (const uint8_t *)&rasgada, FLASHLOG_PAGE_SIZE);
+
+    // a página corrompida é pulada: a cabeça segue depois dela, o boot vem da última válida
+    flashlog_t reboot;
+    CHECK(flashlog_init(&reboot, REGIAO_OFFSET, REGIAO_TAMANHO, TAMANHO_REGISTRO));
+    CHECK(reboot.head == 4 && reboot.boot == 2);
+    CHECK(flashlog_page(&reboot, 3) == NULL);
+    for (uint32_t seq = 0; seq < 3; seq++) conferir_pagina(&reboot, seq, 1);
+    gravar_paginas(&reboot, 1);
+    conferir_pagina(&reboot, 4, 2);
+}
+
+int main(void) {
+    teste_regiao_invalida();
+    teste_acrescimo_e_recuperacao();
+    teste_volta_pelos_setores();
+    teste_pagina_interrompida();
+    printf("flashlog: ok\n");
+    return 0;
+}
@@ -28,44 +28,64 @@ bool aht20_init(i2c_inst_t *i2c) {
     return false;  // Falhou na calibração
 }
 
-bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+bool aht20_start_measurement(i2c_inst_t *i2c) {
     uint8_t trigger_cmd[3] = {AHT20_CMD_TRIGGER, 0x33, 0x00};
-    uint8_t buffer[6];
+    return i2c_write_blocking(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false) == 3;
+}
 
-    // Envia comando de medição
-    i2c_write_blocking(i2c, AHT20_I2C_ADDR, trigger_cmd, 3, false);
-    
-    // Aguarda até o sensor estar pronto
+bool aht20_measurement_ready(i2c_inst_t *i2c) {
+    // Uma única leitura do status, sem esperar
     uint8_t status;
-    for (int i = 0; i < 10; i++) {
-        i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false);
-        if (!(status & AHT20_STATUS_BUSY)) {
-            break;
-        }
-        sleep_ms(10);
-    }
-    
-    // Se ainda estiver ocupado, falha na leitura
-    if (status & AHT20_STATUS_BUSY) {
+    if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, &status, 1, false) != 1) {
         return false;
     }
+    return !(status & AHT20_STATUS_BUSY);
+}
+
+bool aht20_fetch(i2c_inst_t *i2c, AHT20_Data *data) {
+    uint8_t buffer[6];
 
     // Lê os 6 bytes de dados
     if (i2c_read_blocking(i2c, AHT20_I2C_ADDR, buffer, 6, false) != 6) {
         return false;
     }
 
+    // O primeiro byte é o status: a conversão ainda não terminou
+    if (buffer[0] & AHT20_STATUS_BUSY) {
+        return false;
+    }
+
     // Processa os dados de umidade (20 bits)
     uint32_t raw_humidity = ((uint32_t)buffer[1] << 12) | ((uint32_t)buffer[2] << 4) | (buffer[3] >> 4);
-    data->humidity = (float)raw_humidity * 100.0 / 1048576.0;
+    // raw * 10000 / 2^20 = raw * 625 / 2^16, arredondado (cabe em 32 bits)
+    data->humidity_c100 = (int32_t)((raw_humidity * 625 + (1u << 15)) >> 16);
 
     // Processa os dados de temperatura (20 bits)
     uint32_t raw_temp = ((uint32_t)(buffer[3] & 0x0F) << 16) | ((uint32_t)buffer[4] << 8) | buffer[5];
-    data->temperature = ((float)raw_temp * 200.0 / 1048576.0) - 50.0;
+    // raw * 20000 / 2^20 - 5000 = raw * 625 / 2^15 - 5000, arredondado
+    data->temperature_c100 = (int32_t)((raw_temp * 625 + (1u << 14)) >> 15) - 5000;
 
     return true;
 }
 
+bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data) {
+    // Envia comando de medição
+    if (!aht20_start_measurement(i2c)) {
+        return false;
+    }
+
+    // Aguarda até o sensor estar pronto
+    for (int i = 0; i < 10; i++) {
+        sleep_ms(10);
+        if (aht20_measurement_ready(i2c)) {
+            return aht20_fetch(i2c, data);
+        }
+    }
+
+    // Se ainda estiver ocupado, falha na leitura
+    return false;
+}
+
 void aht20_reset(i2c_inst_t *i2c) {
     uint8_t reset_cmd = AHT20_CMD_RESET;
     i2c_write_blocking(i2c, AHT20_I2C_ADDR, &reset_cmd, 1, false);
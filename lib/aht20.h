@@ -10,18 +10,31 @@
 #define AHT20_CMD_TRIGGER   0xAC
 #define AHT20_CMD_RESET     0xBA
 
-// Estrutura para armazenar os valores de temperatura e umidade
+// Estrutura para armazenar os valores de temperatura e umidade, em ponto fixo
 typedef struct {
-    float temperature;
-    float humidity;
+    int32_t temperature_c100;   // centésimos de °C
+    int32_t humidity_c100;      // centésimos de %
 } AHT20_Data;
 
 // Inicializa o sensor AHT20
 bool aht20_init(i2c_inst_t *i2c);
 
-// Faz a leitura de temperatura e umidade do AHT20
+// Faz a leitura de temperatura e umidade do AHT20 (bloqueia até ~100 ms)
 bool aht20_read(i2c_inst_t *i2c, AHT20_Data *data);
 
+// API não bloqueante: dispara a conversão, consulta o bit de ocupado e busca o resultado.
+// A conversão leva ~80 ms (AHT20_CONVERSION_MS) entre o disparo e os dados prontos.
+#define AHT20_CONVERSION_MS 80
+
+// Envia o comando de medição
+bool aht20_start_measurement(i2c_inst_t *i2c);
+
+// Lê o status uma vez; true quando a conversão terminou
+bool aht20_measurement_ready(i2c_inst_t *i2c);
+
+// Lê e converte o resultado da última conversão
+bool aht20_fetch(i2c_inst_t *i2c, AHT20_Data *data);
+
 // Reseta o sensor AHT20
 void aht20_reset(i2c_inst_t *i2c);
 
@@ -0,0 +1,106 @@
+#include "alerts.h"
+
+static void alerts_precompute(alerts_t *a, alert_rule_t *r) {
+    const alert_rule_config_t *c = &r->config;
+    // limitados a ±2^30, -threshold e trip - hysteresis não estouram 32 bits
+    int32_t hysteresis = c->hysteresis > 0 ? c->hysteresis : 0;
+    if (hysteresis > ALERT_VALUE_MAX) hysteresis = ALERT_VALUE_MAX;
+    int32_t threshold = c->threshold;
+    if (threshold > ALERT_VALUE_MAX) threshold = ALERT_VALUE_MAX;
+    if (threshold < -ALERT_VALUE_MAX) threshold = -ALERT_VALUE_MAX;
+    // BELOW compara -valor com -limite; FALL compara a queda (-variação) com o limite positivo
+    r->sign = (c->kind == ALERT_BELOW || c->kind == ALERT_FALL) ? -1 : 1;
+    r->trip = (c->kind == ALERT_BELOW) ? -threshold : threshold;
+    r->release = r->trip - hysteresis;
+    uint32_t points = c->window_s / a->period_s;
+    if (points < 1) points = 1;
+    if (points > a->capacity - 1) points = a->capacity - 1;
+    r->window_points = points;
+}
+
+void alerts_init(alerts_t *a, alert_rule_t *rules, const alert_rule_config_t *configs, uint32_t num_rules,
+                 alert_point_t *points, uint32_t capacity, uint32_t period_s) {
+    a->rules = rules;
+    a->num_rules = num_rules > ALERT_MAX_RULES ? ALERT_MAX_RULES : num_rules;
+    a->points = points;
+    a->capacity = capacity;
+    a->head = 0;
+    a->count = 0;
+    a->period_s = period_s ? period_s : 1;
+    a->next_point_ms = 0;
+    a->active_mask = 0;
+    for (uint32_t i = 0; i < a->num_rules; i++) {
+        rules[i].active = false;
+        rules[i].changing = false;
+        rules[i].config = configs[i];
+        alerts_precompute(a, &rules[i]);
+    }
+}
+
+void alerts_set_rule(alerts_t *a, uint32_t index, const alert_rule_config_t *config) {
+    if (index >= a->num_rules) return;
+    alert_rule_t *r = &a->rules[index];
+    if (config->kind != r->config.kind || config->channel != r->config.channel || !config->enabled) {
+        r->active = false;                  // outra medida: o estado anterior não vale mais
+        a->active_mask &= ~(1u << index);
+    }
+    r->config = *config;
+    r->changing = false;
+    alerts_precompute(a, r);
+}
+
+// medida da regra: o próprio valor ou a variação desde window_points pontos atrás
+static bool alerts_measure(const alerts_t *a, const alert_rule_t *r, const int32_t values[ALERT_CHANNELS],
+                           int32_t *out) {
+    int32_t value = values[r->config.channel];
+    if (r->config.kind == ALERT_ABOVE || r->config.kind == ALERT_BELOW) {
+        *out = value;
+        return true;
+    }
+    if (a->count <= r->window_points) return false; // histórico ainda mais curto que a janela
+    uint32_t index = (a->head + a->capacity - 1 - r->window_points) % a->capacity;
+    *out = value - a->points[index].values[r->config.channel];
+    return true;
+}
+
+bool alerts_evaluate(alerts_t *a, uint32_t now_ms, const int32_t values[ALERT_CHANNELS]) {
+    bool changed = false;
+    for (uint32_t i = 0; i < a->num_rules; i++) {
+        alert_rule_t *r = &a->rules[i];
+        int32_t measure;
+        if (!r->config.enabled || r->config.channel >= ALERT_CHANNELS || !alerts_measure(a, r, values, &measure)) {
+            r->changing = false;
+            continue;
+        }
+        int32_t x = r->sign * measure;
+        bool change = r->active ? x <= r->release : x > r->trip;
+        if (!change) {
+            r->changing = false;
+            continue;
+        }
+        if (!r->changing) {
+            r->changing = true;
+            r->since_ms = now_ms;
+        }
+        if (now_ms - r->since_ms >= r->config.hold_ms) {
+            r->active = !r->active;
+            r->changing = false;
+            a->active_mask ^= 1u << i;
+            changed = true;
+        }
+    }
+
+    // um ponto por período na fila das regras de variação (depois da avaliação, para a
+    // janela nunca comparar a amostra com ela mesma)
+    if (a->count == 0) a->next_point_ms = now_ms;
+    if ((int32_t)(now_ms - a->next_point_ms) >= 0) {
+        alert_point_t *p = &a->points[a->head];
+        p->timestamp_ms = now_ms;
+        for (int c = 0; c < ALERT_CHANNELS; c++) p->values[c] = values[c];
+        a->head = (a->head + 1) % a->capacity;
+        if (a->count < a->capacity) a->count++;
+        a->next_point_ms += a->period_s * 1000u;
+        if ((int32_t)(now_ms - a->next_point_ms) >= 0) a->next_point_ms = now_ms + a->period_s * 1000u;
+    }
+    return changed;
+}
@@ -0,0 +1,84 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Motor de regras de alerta avaliado a cada amostra. Cada regra observa um canal (valores
+// inteiros já escalados, como os de rollup_add) e compara o próprio valor (limite acima ou
+// abaixo) ou a variação numa janela de tempo (subida ou queda) com um limite.
+// - histerese: depois de disparada, a regra só solta quando o valor volta além do limite
+//   pela largura da banda, então leituras em cima do limite não fazem o alerta piscar;
+// - espera (hold_ms): disparo e liberação só acontecem se a nova condição persistir por
+//   esse tempo, o que também garante esse tempo mínimo em cada estado;
+// - variação: o motor guarda uma amostra por period_s numa fila circular própria; a
+//   janela de cada regra vira um deslocamento fixo nessa fila, então a avaliação é O(1).
+// Os limites são convertidos na edição para uma comparação única "x > trip" / "x <= release"
+// sobre o valor com sinal ajustado, sem casos por tipo na avaliação.
+
+#define ALERT_CHANNELS 4
+#define ALERT_MAX_RULES 32      // estados publicados numa máscara de 32 bits
+#define ALERT_VALUE_MAX (1 << 30) // |threshold| e hysteresis são limitados a isto
+
+typedef enum {
+    ALERT_ABOVE,                // valor > threshold
+    ALERT_BELOW,                // valor < threshold
+    ALERT_RISE,                 // subida maior que threshold em window_s
+    ALERT_FALL,                 // queda maior que threshold em window_s
+} alert_kind_t;
+
+typedef struct {
+    alert_kind_t kind;
+    uint8_t channel;            // índice em values[]
+    bool enabled;
+    int32_t threshold;          // nas unidades do canal (variação para RISE/FALL)
+    int32_t hysteresis;         // largura da banda para soltar (>= 0)
+    uint32_t hold_ms;           // tempo que a condição precisa persistir para mudar o estado
+    uint32_t window_s;          // janela de RISE/FALL, arredondada para múltiplos de period_s
+} alert_rule_config_t;
+
+typedef struct {
+    alert_rule_config_t config;
+    int8_t sign;                // +1 ou -1: transforma todos os tipos em "x > trip"
+    int32_t trip;               // dispara quando sign * medida > trip
+    int32_t release;            // solta quando sign * medida <= release
+    uint32_t window_points;     // deslocamento da janela na fila de amostras
+    bool active;
+    bool changing;              // a condição de mudança está valendo desde since_ms
+    uint32_t since_ms;
+} alert_rule_t;
+
+typedef struct {
+    uint32_t timestamp_ms;
+    int32_t values[ALERT_CHANNELS];
+} alert_point_t;
+
+typedef struct {
+    alert_rule_t *rules;
+    uint32_t num_rules;
+    alert_point_t *points;      // fila circular das amostras usadas pelas regras de variação
+    uint32_t capacity;
+    uint32_t head;              // posição do próximo ponto
+    uint32_t count;
+    uint32_t period_s;
+    uint32_t next_point_ms;
+    uint32_t active_mask;       // bit i: regra i disparada
+} alerts_t;
+
+// Inicializa o motor com num_rules regras (cópias de configs) e uma fila de capacity
+// pontos, um a cada period_s; a janela máxima das regras de variação é capacity - 1 períodos
+void alerts_init(alerts_t *a, alert_rule_t *rules, const alert_rule_config_t *configs, uint32_t num_rules,
+                 alert_point_t *points, uint32_t capacity, uint32_t period_s);
+
+// Troca a configuração de uma regra; o estado atual é mantido (exceto se desabilitada) e
+// os novos limites valem a partir da próxima amostra
+void alerts_set_rule(alerts_t *a, uint32_t index, const alert_rule_config_t *config);
+
+// Avalia todas as regras com uma nova amostra; true se alguma mudou de estado
+bool alerts_evaluate(alerts_t *a, uint32_t now_ms, const int32_t values[ALERT_CHANNELS]);
+
+static inline uint32_t alerts_active_mask(const alerts_t *a) {
+    return a->active_mask;
+}
+
+#endif // ALERTS_H
@@ -0,0 +1,51 @@
+#include "altitude.h"
+
+#define RATIO_FRAC_BITS 22              // razão p / p0 em ponto fixo Q22
+#define TABLE_START (1u << (RATIO_FRAC_BITS - 1))   // r = 0.5
+#define TABLE_STEP_BITS 14              // passo de 1/256 em Q22
+#define TABLE_ENTRIES 161
+
+// altitude (cm) para r = 0.5 + i / 256, gerada por tools/altitude_table.py (já compensada
+// pela curvatura entre os nós)
+static const int32_t altitude_table[TABLE_ENTRIES] = {
+    547813, 542055, 536333, 530646, 524995, 519378, 513795, 508246,
+    502730, 497247, 491796, 486377, 480990, 475633, 470308, 465012,
+    459747, 454511, 449304, 444126, 438976, 433855, 428761, 423694,
+    418655, 413643, 408657, 403697, 398763, 393854, 388971, 384113,
+    379279, 374470, 369685, 364923, 360186, 355471, 350780, 346112,
+    341466, 336842, 332241, 327662, 323104, 318567, 314052, 309557,
+    305084, 300631, 296198, 291785, 287393, 283020, 278666, 274332,
+    270017, 265721, 261444, 257185, 252945, 248723, 244519, 240332,
+    236164, 232013, 227879, 223763, 219664, 215582, 211516, 207467,
+    203434, 199418, 195418, 191434, 187465, 183513, 179576, 175654,
+    171748, 167857, 163981, 160120, 156274, 152442, 148625, 144822,
+    141034, 137259, 133499, 129753, 126021, 122302, 118597, 114905,
+    111227, 107562, 103910, 100272, 96646, 93033, 89433, 85845,
+    82270, 78708, 75158, 71620, 68094, 64580, 61079, 57589,
+    54111, 50645, 47190, 43747, 40315, 36895, 33486, 30088,
+    26702, 23326, 19961, 16608, 13265, 9933, 6611, 3300,
+    -1, -3291, -6571, -9840, -13099, -16348, -19587, -22817,
+    -26036, -29245, -32445, -35634, -38814, -41985, -45146, -48298,
+    -51440, -54572, -57696, -60810, -63915, -67011, -70098, -73177,
+    -76246, -79306, -82357, -85400, -88434, -91459, -94476, -97484,
+    -100484,
+};
+
+int32_t altitude_cm(int32_t pressure_pa, int32_t sea_level_pa) {
+    if (sea_level_pa <= 0) return 0;
+    if (pressure_pa < 0) pressure_pa = 0;
+    if (pressure_pa > 131071) pressure_pa = 131071;
+
+    // r em Q22 com duas divisões de 32 bits: 15 bits inteiros do quociente e mais 7 do resto
+    uint32_t p = (uint32_t)pressure_pa << 15;
+    uint32_t p0 = (uint32_t)sea_level_pa;
+    uint32_t ratio = (p / p0) << 7 | ((p % p0) << 7) / p0;
+
+    if (ratio <= TABLE_START) return altitude_table[0];
+    uint32_t offset = ratio - TABLE_START;
+    uint32_t i = offset >> TABLE_STEP_BITS;
+    if (i >= TABLE_ENTRIES - 1) return altitude_table[TABLE_ENTRIES - 1];
+    int32_t frac = (int32_t)(offset & ((1u << TABLE_STEP_BITS) - 1));
+    int32_t diff = altitude_table[i + 1] - altitude_table[i];
+    return altitude_table[i] + diff * frac / (1 << TABLE_STEP_BITS);
+}
@@ -0,0 +1,18 @@
+#ifndef ALTITUDE_H
+#define ALTITUDE_H
+
+#include <stdint.h>
+
+// Altitude barométrica em ponto fixo, sem float nem pow(): a fórmula
+// h = 44330 * (1 - (p / p0)^0.1903) é tabelada pela razão r = p / p0 e interpolada
+// linearmente. A tabela cobre r de 0.5 a 1.125 (cerca de +5400 m a -1000 m com
+// p0 = 1013.25 hPa), com erro abaixo de 5 cm nessa faixa; fora dela o resultado
+// satura nos extremos.
+
+#define ALTITUDE_SEA_LEVEL_PA 101325    // pressão de referência padrão ao nível do mar
+
+// Altitude em centímetros para a pressão medida e a pressão de referência ao nível do
+// mar, ambas em Pa (até 131071 Pa); 0 se sea_level_pa não for positiva
+int32_t altitude_cm(int32_t pressure_pa, int32_t sea_level_pa);
+
+#endif // ALTITUDE_H
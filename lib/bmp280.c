@@ -1,43 +1,135 @@
 #include "bmp280.h"
 #include "hardware/i2c.h"
 
-#define ADDR _u(0x76)
+// Mapa de registradores, de uso interno do driver
+#define REG_CONFIG _u(0xF5)
+#define REG_CTRL_MEAS _u(0xF4)
+#define REG_RESET _u(0xE0)
+#define REG_STATUS _u(0xF3)
+
+#define STATUS_MEASURING 0x08
+
+#define REG_TEMP_XLSB _u(0xFC)
+#define REG_TEMP_LSB _u(0xFB)
+#define REG_TEMP_MSB _u(0xFA)
+
+#define REG_PRESSURE_XLSB _u(0xF9)
+#define REG_PRESSURE_LSB _u(0xF8)
+#define REG_PRESSURE_MSB _u(0xF7)
+
+#define REG_DIG_T1_LSB _u(0x88)
+#define REG_DIG_T1_MSB _u(0x89)
+#define REG_DIG_T2_LSB _u(0x8A)
+#define REG_DIG_T2_MSB _u(0x8B)
+#define REG_DIG_T3_LSB _u(0x8C)
+#define REG_DIG_T3_MSB _u(0x8D)
+#define REG_DIG_P1_LSB _u(0x8E)
+#define REG_DIG_P1_MSB _u(0x8F)
+#define REG_DIG_P2_LSB _u(0x90)
+#define REG_DIG_P2_MSB _u(0x91)
+#define REG_DIG_P3_LSB _u(0x92)
+#define REG_DIG_P3_MSB _u(0x93)
+#define REG_DIG_P4_LSB _u(0x94)
+#define REG_DIG_P4_MSB _u(0x95)
+#define REG_DIG_P5_LSB _u(0x96)
+#define REG_DIG_P5_MSB _u(0x97)
+#define REG_DIG_P6_LSB _u(0x98)
+#define REG_DIG_P6_MSB _u(0x99)
+#define REG_DIG_P7_LSB _u(0x9A)
+#define REG_DIG_P7_MSB _u(0x9B)
+#define REG_DIG_P8_LSB _u(0x9C)
+#define REG_DIG_P8_MSB _u(0x9D)
+#define REG_DIG_P9_LSB _u(0x9E)
+#define REG_DIG_P9_MSB _u(0x9F)
+
+#define NUM_CALIB_PARAMS 24
+
+// valor de ctrl_meas para a configuração, no modo pedido
+static uint8_t ctrl_meas_value(const bmp280_config_t *config, bmp280_mode_t mode) {
+    return (uint8_t)((config->osrs_temp << 5) | (config->osrs_press << 2) | mode);
+}
 
 void bmp280_init(i2c_inst_t *i2c) {
-    uint8_t buf[2];
-    const uint8_t reg_config_val = ((0x04 << 5) | (0x05 << 2)) & 0xFC;
+    const bmp280_config_t config = BMP280_CONFIG_DEFAULT;
+    bmp280_configure(i2c, &config);
+}
+
+bool bmp280_configure(i2c_inst_t *i2c, const bmp280_config_t *config) {
+    // escritas em config podem ser ignoradas no modo normal: o sensor vai para sleep antes
+    uint8_t buf[2] = { REG_CTRL_MEAS, ctrl_meas_value(config, BMP280_MODE_SLEEP) };
+    if (i2c_write_blocking(i2c, BMP280_I2C_ADDR, buf, 2, false) != 2) return false;
+
     buf[0] = REG_CONFIG;
-    buf[1] = reg_config_val;
-   
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+    buf[1] = (uint8_t)((config->standby << 5) | (config->filter << 2));
+    if (i2c_write_blocking(i2c, BMP280_I2C_ADDR, buf, 2, false) != 2) return false;
 
-    const uint8_t reg_ctrl_meas_val = (0x01 << 5) | (0x03 << 2) | (0x03);
+    // no modo forced a conversão só começa em bmp280_start_measurement()
+    if (config->mode != BMP280_MODE_NORMAL) return true;
     buf[0] = REG_CTRL_MEAS;
-    buf[1] = reg_ctrl_meas_val;
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
- //   printf("Ctrl_meas register value: %x\n", reg_ctrl_meas_val);
+    buf[1] = ctrl_meas_value(config, BMP280_MODE_NORMAL);
+    return i2c_write_blocking(i2c, BMP280_I2C_ADDR, buf, 2, false) == 2;
+}
+
+uint32_t bmp280_measurement_time_ms(const bmp280_config_t *config) {
+    static const uint8_t samples[8] = { 0, 1, 2, 4, 8, 16, 16, 16 };
+    // máximo do datasheet: 1,25 ms + 2,3 ms por amostra de temperatura + 2,3 ms por
+    // amostra de pressão + 0,575 ms se a pressão estiver ligada
+    uint32_t us = 1250 + 2300u * samples[config->osrs_temp & 7];
+    if (config->osrs_press != BMP280_OSRS_SKIP) us += 2300u * samples[config->osrs_press & 7] + 575;
+    return (us + 999) / 1000;
 }
 
 void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure) {
+    bmp280_fetch_raw(i2c, temp, pressure);
+}
+
+bool bmp280_start_measurement(i2c_inst_t *i2c, const bmp280_config_t *config) {
+    // modo normal: o sensor já converte sozinho e os registradores têm sempre a última leitura
+    if (config->mode == BMP280_MODE_NORMAL) return true;
+    // modo forced: uma conversão e o sensor volta a dormir
+    uint8_t buf[2] = { REG_CTRL_MEAS, ctrl_meas_value(config, BMP280_MODE_FORCED) };
+    return i2c_write_blocking(i2c, BMP280_I2C_ADDR, buf, 2, false) == 2;
+}
+
+bool bmp280_measurement_ready(i2c_inst_t *i2c) {
+    uint8_t reg = REG_STATUS;
+    uint8_t status;
+    if (i2c_write_blocking(i2c, BMP280_I2C_ADDR, &reg, 1, true) != 1 ||
+        i2c_read_blocking(i2c, BMP280_I2C_ADDR, &status, 1, false) != 1) {
+        return false;
+    }
+    return !(status & STATUS_MEASURING);
+}
+
+bool bmp280_fetch_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure) {
     uint8_t buf[6];
     uint8_t reg = REG_PRESSURE_MSB;
-    i2c_write_blocking(i2c, ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c, ADDR, buf, 6, false);
+    if (i2c_write_blocking(i2c, BMP280_I2C_ADDR, &reg, 1, true) != 1 ||
+        i2c_read_blocking(i2c, BMP280_I2C_ADDR, buf, 6, false) != 6) {
+        return false;
+    }
 
     *pressure = (buf[0] << 12) | (buf[1] << 4) | (buf[2] >> 4);
     *temp = (buf[3] << 12) | (buf[4] << 4) | (buf[5] >> 4);
-
-
+    return true;
 }
 
 void bmp280_reset(i2c_inst_t *i2c) {
     uint8_t buf[2] = { REG_RESET, 0xB6 };
-    i2c_write_blocking(i2c, ADDR, buf, 2, false);
+    i2c_write_blocking(i2c, BMP280_I2C_ADDR, buf, 2, false);
+}
+
+bool bmp280_read(i2c_inst_t *i2c, const struct bmp280_calib_param* params, const bmp280_config_t *config,
+                 bmp280_reading_t *reading) {
+    int32_t raw_temp, raw_press;
+    if (!bmp280_fetch_raw(i2c, &raw_temp, &raw_press)) return false;
+    bmp280_compensate(raw_temp, raw_press, params, config->compensation_64bit, reading);
+    return true;
 }
 
 // função intermediária que calcula a temperatura de resolução fina
 // usada tanto para conversões de pressão quanto de temperatura
-int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params) {
+static int32_t bmp280_convert(int32_t temp, const struct bmp280_calib_param* params) {
     // usa os 32 bits de compensação de ponto fixo implementados no datasheet
     int32_t var1, var2;
     var1 = ((((temp >> 3) - ((int32_t)params->dig_t1 << 1))) * ((int32_t)params->dig_t2)) >> 11;
@@ -45,18 +137,8 @@ int32_t bmp280_convert(int32_t temp, struct bmp280_calib_param* params) {
     return var1 + var2;
 }
 
-int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params) {
-    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de temperatura lido de seus registradores
-    int32_t t_fine = bmp280_convert(temp, params);
-    return (t_fine * 5 + 128) >> 8;
-}
-
-
-int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params) {
-    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de pressão lido de seus registradores
-
-    int32_t t_fine = bmp280_convert(temp, params);
-
+// compensação de pressão em 32 bits do datasheet, a partir de um t_fine já calculado; Pa
+static uint32_t compensate_pressure32(int32_t pressure, int32_t t_fine, const struct bmp280_calib_param* params) {
     int32_t var1, var2;
     uint32_t converted = 0.0;
     var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
@@ -80,11 +162,57 @@ int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_ca
     return converted;
 }
 
+// compensação de pressão em 64 bits do datasheet; Pa em Q24.8
+static uint32_t compensate_pressure64(int32_t pressure, int32_t t_fine, const struct bmp280_calib_param* params) {
+    int64_t var1, var2, p;
+    var1 = (int64_t)t_fine - 128000;
+    var2 = var1 * var1 * (int64_t)params->dig_p6;
+    var2 = var2 + ((var1 * (int64_t)params->dig_p5) << 17);
+    var2 = var2 + ((int64_t)params->dig_p4 << 35);
+    var1 = ((var1 * var1 * (int64_t)params->dig_p3) >> 8) + ((var1 * (int64_t)params->dig_p2) << 12);
+    var1 = ((((int64_t)1) << 47) + var1) * (int64_t)params->dig_p1 >> 33;
+    if (var1 == 0) {
+        return 0;  // avoid exception caused by division by zero
+    }
+    p = 1048576 - pressure;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = ((int64_t)params->dig_p9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)params->dig_p8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + ((int64_t)params->dig_p7 << 4);
+    return (uint32_t)p;
+}
+
+void bmp280_compensate(int32_t raw_temp, int32_t raw_press, const struct bmp280_calib_param* params,
+                       bool compensation_64bit, bmp280_reading_t *reading) {
+    // t_fine é calculado uma vez e alimenta as duas compensações
+    int32_t t_fine = bmp280_convert(raw_temp, params);
+    reading->temperature_c100 = (t_fine * 5 + 128) >> 8;
+    if (compensation_64bit) {
+        reading->pressure_q8 = compensate_pressure64(raw_press, t_fine, params);
+        reading->pressure_pa = (reading->pressure_q8 + 128) >> 8;
+    } else {
+        reading->pressure_pa = compensate_pressure32(raw_press, t_fine, params);
+        reading->pressure_q8 = reading->pressure_pa << 8;
+    }
+}
+
+int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params) {
+    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de temperatura lido de seus registradores
+    int32_t t_fine = bmp280_convert(temp, params);
+    return (t_fine * 5 + 128) >> 8;
+}
+
+int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params) {
+    // Utiliza os parâmetros de calibração do BMP280 para compensar o valor de pressão lido de seus registradores.
+    // Recalcula t_fine; quem também precisa da temperatura deve usar bmp280_compensate()
+    return (int32_t)compensate_pressure32(pressure, bmp280_convert(temp, params), params);
+}
+
 void bmp280_get_calib_params(i2c_inst_t *i2c, struct bmp280_calib_param* params) {
     uint8_t buf[NUM_CALIB_PARAMS] = { 0 };
     uint8_t reg = REG_DIG_T1_LSB;
-    i2c_write_blocking(i2c, ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c, ADDR, buf, NUM_CALIB_PARAMS, false);
+    i2c_write_blocking(i2c, BMP280_I2C_ADDR, &reg, 1, true);
+    i2c_read_blocking(i2c, BMP280_I2C_ADDR, buf, NUM_CALIB_PARAMS, false);
 
     params->dig_t1 = (uint16_t)(buf[1] << 8) | buf[0];
     params->dig_t2 = (int16_t)(buf[3] << 8) | buf[2];
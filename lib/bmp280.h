@@ -3,47 +3,8 @@
 
 #include "hardware/i2c.h"
 
-// Defina os endereços e registros conforme o código original
-#define ADDR _u(0x76)
-
-#define REG_CONFIG _u(0xF5)
-#define REG_CTRL_MEAS _u(0xF4)
-#define REG_RESET _u(0xE0)
-
-#define REG_TEMP_XLSB _u(0xFC)
-#define REG_TEMP_LSB _u(0xFB)
-#define REG_TEMP_MSB _u(0xFA)
-
-#define REG_PRESSURE_XLSB _u(0xF9)
-#define REG_PRESSURE_LSB _u(0xF8)
-#define REG_PRESSURE_MSB _u(0xF7)
-
-#define REG_DIG_T1_LSB _u(0x88)
-#define REG_DIG_T1_MSB _u(0x89)
-#define REG_DIG_T2_LSB _u(0x8A)
-#define REG_DIG_T2_MSB _u(0x8B)
-#define REG_DIG_T3_LSB _u(0x8C)
-#define REG_DIG_T3_MSB _u(0x8D)
-#define REG_DIG_P1_LSB _u(0x8E)
-#define REG_DIG_P1_MSB _u(0x8F)
-#define REG_DIG_P2_LSB _u(0x90)
-#define REG_DIG_P2_MSB _u(0x91)
-#define REG_DIG_P3_LSB _u(0x92)
-#define REG_DIG_P3_MSB _u(0x93)
-#define REG_DIG_P4_LSB _u(0x94)
-#define REG_DIG_P4_MSB _u(0x95)
-#define REG_DIG_P5_LSB _u(0x96)
-#define REG_DIG_P5_MSB _u(0x97)
-#define REG_DIG_P6_LSB _u(0x98)
-#define REG_DIG_P6_MSB _u(0x99)
-#define REG_DIG_P7_LSB _u(0x9A)
-#define REG_DIG_P7_MSB _u(0x9B)
-#define REG_DIG_P8_LSB _u(0x9C)
-#define REG_DIG_P8_MSB _u(0x9D)
-#define REG_DIG_P9_LSB _u(0x9E)
-#define REG_DIG_P9_MSB _u(0x9F)
-
-#define NUM_CALIB_PARAMS 24
+// Endereço I2C do BMP280 (SDO em GND)
+#define BMP280_I2C_ADDR _u(0x76)
 
 struct bmp280_calib_param {
     uint16_t dig_t1;
@@ -61,9 +22,84 @@ struct bmp280_calib_param {
     int16_t dig_p9;
 };
 
+// Sobreamostragem de cada canal (campos osrs_t/osrs_p de ctrl_meas); SKIP desliga o canal
+typedef enum {
+    BMP280_OSRS_SKIP = 0,
+    BMP280_OSRS_X1 = 1,
+    BMP280_OSRS_X2 = 2,
+    BMP280_OSRS_X4 = 3,
+    BMP280_OSRS_X8 = 4,
+    BMP280_OSRS_X16 = 5,
+} bmp280_osrs_t;
+
+// Coeficiente do filtro IIR interno (campo filter de config)
+typedef enum {
+    BMP280_FILTER_OFF = 0,
+    BMP280_FILTER_2 = 1,
+    BMP280_FILTER_4 = 2,
+    BMP280_FILTER_8 = 3,
+    BMP280_FILTER_16 = 4,
+} bmp280_filter_t;
+
+// Pausa entre conversões no modo normal (campo t_sb de config)
+typedef enum {
+    BMP280_STANDBY_0_5_MS = 0,
+    BMP280_STANDBY_62_5_MS = 1,
+    BMP280_STANDBY_125_MS = 2,
+    BMP280_STANDBY_250_MS = 3,
+    BMP280_STANDBY_500_MS = 4,
+    BMP280_STANDBY_1000_MS = 5,
+    BMP280_STANDBY_2000_MS = 6,
+    BMP280_STANDBY_4000_MS = 7,
+} bmp280_standby_t;
+
+// Forced: uma conversão por bmp280_start_measurement() e o sensor volta a dormir (menor consumo).
+// Normal: o sensor converte sozinho a cada standby e os registradores guardam a última conversão
+typedef enum {
+    BMP280_MODE_SLEEP = 0,
+    BMP280_MODE_FORCED = 1,
+    BMP280_MODE_NORMAL = 3,
+} bmp280_mode_t;
+
+// Configuração de aquisição: mais sobreamostragem e filtro reduzem o ruído, ao custo de
+// conversões mais longas (bmp280_measurement_time_ms) e de mais consumo
+typedef struct {
+    bmp280_osrs_t osrs_temp;
+    bmp280_osrs_t osrs_press;
+    bmp280_filter_t filter;
+    bmp280_standby_t standby;     // usado só no modo normal
+    bmp280_mode_t mode;
+    bool compensation_64bit;      // compensação de pressão em 64 bits (precisão total do datasheet)
+} bmp280_config_t;
+
+// Configuração usada por bmp280_init(): temperatura x1, pressão x4, filtro 16, modo forced
+#define BMP280_CONFIG_DEFAULT { BMP280_OSRS_X1, BMP280_OSRS_X4, BMP280_FILTER_16, \
+                                BMP280_STANDBY_500_MS, BMP280_MODE_FORCED, false }
+
+// Leitura compensada
+typedef struct {
+    int32_t temperature_c100;     // centésimos de °C
+    uint32_t pressure_pa;         // Pa
+    uint32_t pressure_q8;         // Pa / 256 (resolução total com a compensação em 64 bits)
+} bmp280_reading_t;
+
 //void bmp280_init(void);
 void bmp280_init(i2c_inst_t *i2c);
+// Aplica a configuração (passa por sleep, como o datasheet pede para alterar config)
+bool bmp280_configure(i2c_inst_t *i2c, const bmp280_config_t *config);
+// Duração máxima de uma conversão com a sobreamostragem configurada (datasheet, seção 3.8.1)
+uint32_t bmp280_measurement_time_ms(const bmp280_config_t *config);
 void bmp280_read_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure);
+// API não bloqueante: dispara uma conversão forced (no modo normal não há o que disparar),
+// consulta o status e busca os valores brutos
+bool bmp280_start_measurement(i2c_inst_t *i2c, const bmp280_config_t *config);
+bool bmp280_measurement_ready(i2c_inst_t *i2c);
+bool bmp280_fetch_raw(i2c_inst_t *i2c, int32_t* temp, int32_t* pressure);
+// Busca e compensa temperatura e pressão numa única passada, com um só t_fine
+bool bmp280_read(i2c_inst_t *i2c, const struct bmp280_calib_param* params, const bmp280_config_t *config,
+                 bmp280_reading_t *reading);
+void bmp280_compensate(int32_t raw_temp, int32_t raw_press, const struct bmp280_calib_param* params,
+                       bool compensation_64bit, bmp280_reading_t *reading);
 void bmp280_reset(i2c_inst_t *i2c);
 int32_t bmp280_convert_temp(int32_t temp, struct bmp280_calib_param* params);
 int32_t bmp280_convert_pressure(int32_t pressure, int32_t temp, struct bmp280_calib_param* params);
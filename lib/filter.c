@@ -0,0 +1,67 @@
+#include "filter.h"
+
+void filter_init(filter_t *f, const filter_config_t *config) {
+    f->config = *config;
+    if (f->config.median_n < 1) f->config.median_n = 1;
+    if (f->config.median_n > FILTER_MEDIAN_MAX) f->config.median_n = FILTER_MEDIAN_MAX;
+    if (!(f->config.median_n & 1)) f->config.median_n--;
+    if (f->config.ema_shift > 15) f->config.ema_shift = 15;
+    f->head = 0;
+    f->fill = 0;
+    f->sum = 0;
+    f->ema_q = 0;
+    f->ema_valid = false;
+    f->count = 0;
+}
+
+// troca a leitura mais antiga da janela pela nova e devolve a mediana
+static int32_t filter_median(filter_t *f, int32_t value) {
+    uint8_t n = f->config.median_n;
+    int i;
+    if (f->fill == n) {
+        // remove a mais antiga da janela ordenada
+        int32_t oldest = f->ring[f->head];
+        for (i = 0; f->sorted[i] != oldest; i++) {}
+        for (; i < n - 1; i++) f->sorted[i] = f->sorted[i + 1];
+        f->ring[f->head] = value;
+        f->head = (uint8_t)((f->head + 1) % n);
+        f->fill--;
+    } else {
+        f->ring[(f->head + f->fill) % n] = value;
+    }
+    // inserção ordenada
+    for (i = f->fill; i > 0 && f->sorted[i - 1] > value; i--) f->sorted[i] = f->sorted[i - 1];
+    f->sorted[i] = value;
+    f->fill++;
+    return f->sorted[f->fill / 2];
+}
+
+void filter_add(filter_t *f, int32_t value) {
+    int32_t median = f->config.median_n > 1 ? filter_median(f, value) : value;
+    if (f->config.mode == FILTER_EMA) {
+        int32_t q = median * (1 << FILTER_EMA_FRAC);
+        if (!f->ema_valid) {
+            f->ema_q = q;                   // primeira leitura: começa no valor, sem rampa
+            f->ema_valid = true;
+        } else {
+            f->ema_q += (q - f->ema_q) >> f->config.ema_shift;
+        }
+    } else {
+        f->sum += median;
+    }
+    f->count++;
+}
+
+bool filter_output(filter_t *f, int32_t *out) {
+    if (f->count == 0) return false;
+    if (f->config.mode == FILTER_EMA) {
+        *out = (f->ema_q + (1 << (FILTER_EMA_FRAC - 1))) >> FILTER_EMA_FRAC;
+    } else {
+        // média arredondada ao mais próximo (metade para longe do zero)
+        int64_t half = f->count / 2;
+        *out = (int32_t)((f->sum >= 0 ? f->sum + half : f->sum - half) / (int64_t)f->count);
+        f->sum = 0;
+    }
+    f->count = 0;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estágio de filtragem de um canal amostrado acima da taxa de publicação, só com inteiros.
+// Cada leitura bruta passa por uma mediana móvel de N leituras (rejeita picos isolados sem
+// atrasar degraus por mais de N/2 leituras) e segue para um de dois suavizadores:
+// - boxcar: média das medianas desde a última saída, ou seja, decimação para a taxa de
+//   publicação com o ruído reduzido pela raiz do número de leituras;
+// - EMA: média exponencial com alfa = 1/2^ema_shift, com 8 bits de fração no estado para
+//   não acumular o erro do truncamento.
+// A mediana mantém a janela ordenada de forma incremental: cada leitura remove a mais
+// antiga e insere a nova com deslocamentos, O(N) por leitura, sem ordenar a janela inteira.
+
+#define FILTER_MEDIAN_MAX 9     // janela máxima da mediana (ímpar)
+#define FILTER_EMA_FRAC 8       // bits de fração do estado da EMA
+
+typedef enum {
+    FILTER_BOXCAR,
+    FILTER_EMA,
+} filter_mode_t;
+
+typedef struct {
+    uint8_t median_n;           // leituras na mediana (1 desliga; pares viram o ímpar abaixo)
+    filter_mode_t mode;
+    uint8_t ema_shift;          // só FILTER_EMA: alfa = 1 / 2^ema_shift
+} filter_config_t;
+
+// mediana de 5 e decimação por média
+#define FILTER_CONFIG_DEFAULT { 5, FILTER_BOXCAR, 3 }
+
+typedef struct {
+    filter_config_t config;
+    int32_t ring[FILTER_MEDIAN_MAX];    // janela da mediana na ordem de chegada
+    int32_t sorted[FILTER_MEDIAN_MAX];  // a mesma janela, ordenada
+    uint8_t head;                       // posição da leitura mais antiga em ring
+    uint8_t fill;                       // leituras na janela
+    int64_t sum;                        // boxcar: soma das medianas desde a última saída
+    int32_t ema_q;                      // EMA: estado com FILTER_EMA_FRAC bits de fração
+    bool ema_valid;                     // EMA: false até a primeira leitura
+    uint32_t count;                     // leituras desde a última saída
+} filter_t;
+
+// Valores até ±2^22 (ex.: Pa, centésimos de °C e de %) cabem no estado da EMA
+void filter_init(filter_t *f, const filter_config_t *config);
+
+// Acrescenta uma leitura bruta
+void filter_add(filter_t *f, int32_t value);
+
+// Valor filtrado desde a última chamada; false (e out intacto) se não houve leituras.
+// No modo boxcar reinicia a média
+bool filter_output(filter_t *f, int32_t *out);
+
+#endif // FILTER_H
@@ -0,0 +1,181 @@
+#include <assert.h>
+#include <string.h>
+
+#include "flashlog.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#define FLASHLOG_ERASED 0xFFFFFFFFu
+#define FLASHLOG_SAFE_TIMEOUT_MS 10     // espera máxima pela pausa do outro núcleo
+
+static_assert(sizeof(flashlog_page_t) == FLASHLOG_PAGE_SIZE, "página do log deve ocupar uma página da flash");
+static_assert(FLASHLOG_PAGE_SIZE == FLASH_PAGE_SIZE && FLASHLOG_SECTOR_SIZE == FLASH_SECTOR_SIZE,
+              "geometria do log difere da flash");
+
+// operação executada com a XIP suspensa (o outro núcleo fica pausado durante ela)
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;    // NULL: apagar o setor em offset
+} flashlog_op_t;
+
+static void flashlog_run_op(void *param) {
+    const flashlog_op_t *op = param;
+    if (op->data) {
+        flash_range_program(op->offset, op->data, FLASHLOG_PAGE_SIZE);
+    } else {
+        flash_range_erase(op->offset, FLASHLOG_SECTOR_SIZE);
+    }
+}
+
+static uint32_t sector_offset(const flashlog_t *log, uint32_t sector) {
+    return log->offset + sector * FLASHLOG_SECTOR_SIZE;
+}
+
+static const flashlog_page_t *page_at(const flashlog_t *log, uint32_t sector, uint32_t page) {
+    return (const flashlog_page_t *)(XIP_BASE + sector_offset(log, sector) + page * FLASHLOG_PAGE_SIZE);
+}
+
+static uint32_t sector_of(const flashlog_t *log, uint32_t seq) {
+    return seq / FLASHLOG_PAGES_PER_SECTOR % log->sectors;
+}
+
+// CRC-16/CCITT (polinômio 0x1021, valor inicial 0xFFFF)
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint32_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*data++ << 8);
+        for (int i = 0; i < 8; i++) {
+            crc = crc & 0x8000 ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t page_crc(const flashlog_page_t *p) {
+    return crc16(crc16(0xFFFF, (const uint8_t *)&p->boot, sizeof(p->boot)), p->payload, FLASHLOG_PAYLOAD_SIZE);
+}
+
+static bool sector_blank(const flashlog_t *log, uint32_t sector) {
+    const uint32_t *words = (const uint32_t *)page_at(log, sector, 0);
+    for (uint32_t i = 0; i < FLASHLOG_SECTOR_SIZE / sizeof(uint32_t); i++) {
+        if (words[i] != FLASHLOG_ERASED) return false;
+    }
+    return true;
+}
+
+static void start_page(flashlog_t *log) {
+    memset(log->page.payload, 0xFF, FLASHLOG_PAYLOAD_SIZE);
+    log->fill = 0;
+    log->page_full = false;
+}
+
+bool flashlog_init(flashlog_t *log, uint32_t offset, uint32_t size, uint32_t record_size) {
+    if (offset % FLASHLOG_SECTOR_SIZE || size / FLASHLOG_SECTOR_SIZE < 3 ||
+        record_size == 0 || record_size > FLASHLOG_PAYLOAD_SIZE) {
+        return false;
+    }
+    log->offset = offset;
+    log->sectors = size / FLASHLOG_SECTOR_SIZE;
+    log->record_size = record_size;
+    log->records_per_page = FLASHLOG_PAYLOAD_SIZE / record_size;
+    log->dropped = 0;
+    start_page(log);
+
+    // setor mais recente: maior sequência na primeira página, coerente com a posição do setor
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint32_t s = 0; s < log->sectors; s++) {
+        uint32_t seq = page_at(log, s, 0)->seq;
+        if (seq == FLASHLOG_ERASED || seq % FLASHLOG_PAGES_PER_SECTOR || sector_of(log, seq) != s) continue;
+        if (!found || seq > newest) {
+            newest = seq;
+            found = true;
+        }
+    }
+
+    log->head = 0;
+    log->boot = 1;
+    if (found) {
+        // dentro do setor as páginas são gravadas em ordem: a cabeça é a primeira apagada
+        uint32_t s = sector_of(log, newest);
+        uint32_t used = 1;
+        while (used < FLASHLOG_PAGES_PER_SECTOR && page_at(log, s, used)->seq != FLASHLOG_ERASED) used++;
+        log->head = newest + used;
+        for (uint32_t p = used; p-- > 0;) {
+            const flashlog_page_t *page = page_at(log, s, p);
+            if (page->seq == newest + p && page->crc == page_crc(page)) {
+                log->boot = (uint16_t)(page->boot + 1);
+                break;
+            }
+        }
+    }
+
+    uint32_t head_sector = sector_of(log, log->head);
+    log->head_ready = log->head % FLASHLOG_PAGES_PER_SECTOR != 0 || sector_blank(log, head_sector);
+    log->next_ready = sector_blank(log, (head_sector + 1) % log->sectors);
+    return true;
+}
+
+bool flashlog_append(flashlog_t *log, const void *record) {
+    if (log->page_full) {
+        log->dropped++;
+        return false;
+    }
+    memcpy(log->page.payload + log->fill * log->record_size, record, log->record_size);
+    if (++log->fill == log->records_per_page) {
+        log->page_full = true;
+    }
+    return true;
+}
+
+bool flashlog_task(flashlog_t *log) {
+    uint32_t head_sector = sector_of(log, log->head);
+    flashlog_op_t op = { 0 };
+    bool *erased = NULL;
+
+    if (!log->head_ready) {
+        // só ocorre logo após o boot; depois o setor da cabeça sempre chega já apagado
+        op.offset = sector_offset(log, head_sector);
+        erased = &log->head_ready;
+    } else if (log->page_full) {
+        log->page.seq = log->head;
+        log->page.boot = log->boot;
+        log->page.crc = page_crc(&log->page);
+        op.offset = sector_offset(log, head_sector) + log->head % FLASHLOG_PAGES_PER_SECTOR * FLASHLOG_PAGE_SIZE;
+        op.data = (const uint8_t *)&log->page;
+    } else if (!log->next_ready) {
+        // apaga antecipadamente o setor seguinte, descartando as páginas mais antigas
+        op.offset = sector_offset(log, (head_sector + 1) % log->sectors);
+        erased = &log->next_ready;
+    } else {
+        return false;
+    }
+
+    // sem o outro núcleo em ponto seguro a operação é tentada de novo na próxima chamada
+    if (flash_safe_execute(flashlog_run_op, &op, FLASHLOG_SAFE_TIMEOUT_MS) != PICO_OK) {
+        return false;
+    }
+
+    if (erased) {
+        *erased = true;
+    } else {
+        start_page(log);
+        if (++log->head % FLASHLOG_PAGES_PER_SECTOR == 0) {
+            log->head_ready = log->next_ready;
+            log->next_ready = false;
+        }
+    }
+    return true;
+}
+
+uint32_t flashlog_first_seq(const flashlog_t *log) {
+    // o setor da cabeça (parcial) e os anteriores, exceto o seguinte, que pode estar apagado
+    uint32_t span = log->head % FLASHLOG_PAGES_PER_SECTOR + (log->sectors - 2) * FLASHLOG_PAGES_PER_SECTOR;
+    return log->head > span ? log->head - span : 0;
+}
+
+const flashlog_page_t *flashlog_page(const flashlog_t *log, uint32_t seq) {
+    if (seq >= log->head || seq < flashlog_first_seq(log)) return NULL;
+    const flashlog_page_t *page = page_at(log, sector_of(log, seq), seq % FLASHLOG_PAGES_PER_SECTOR);
+    if (page->seq != seq || page->crc != page_crc(page)) return NULL;
+    return page;
+}
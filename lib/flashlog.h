@@ -0,0 +1,66 @@
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Registro de amostras na flash: log somente de acréscimo em uma região reservada.
+// Os registros (de tamanho fixo) são acumulados em RAM e gravados uma página por vez;
+// cada página recebe um número de sequência absoluto que também determina sua posição
+// (setor = seq / páginas por setor, módulo o número de setores), de modo que o log gira
+// pelos setores e os apagamentos ficam distribuídos igualmente.
+// No boot a cabeça de escrita é recuperada lendo apenas a primeira página de cada setor
+// e as páginas do setor mais recente. Apagar e gravar são feitos em flashlog_task, no
+// máximo uma operação por chamada, e o setor seguinte é apagado antecipadamente, para
+// que um acréscimo nunca espere por um apagamento.
+
+#define FLASHLOG_PAGE_SIZE 256
+#define FLASHLOG_SECTOR_SIZE 4096
+#define FLASHLOG_PAGES_PER_SECTOR (FLASHLOG_SECTOR_SIZE / FLASHLOG_PAGE_SIZE)
+#define FLASHLOG_PAYLOAD_SIZE (FLASHLOG_PAGE_SIZE - 8)
+
+typedef struct {
+    uint32_t seq;           // sequência absoluta da página (0xFFFFFFFF: apagada)
+    uint16_t boot;          // número do boot em que a página foi gravada
+    uint16_t crc;           // CRC-16/CCITT de boot e payload (detecta gravações interrompidas)
+    uint8_t payload[FLASHLOG_PAYLOAD_SIZE];
+} flashlog_page_t;
+
+typedef struct {
+    uint32_t offset;            // início da região na flash (alinhado ao setor)
+    uint32_t sectors;           // setores da região (mínimo 3)
+    uint32_t record_size;
+    uint32_t records_per_page;
+    uint32_t head;              // sequência da próxima página a gravar
+    uint16_t boot;              // número deste boot
+    bool head_ready;            // setor da cabeça apagado a partir da página da cabeça
+    bool next_ready;            // setor seguinte já apagado
+    bool page_full;             // página em RAM aguardando gravação
+    uint32_t fill;              // registros na página em RAM
+    uint32_t dropped;           // registros descartados com a página cheia
+    flashlog_page_t page;       // página em montagem
+} flashlog_t;
+
+// Recupera a cabeça de escrita do log em [offset, offset + size); false se a região é inválida
+bool flashlog_init(flashlog_t *log, uint32_t offset, uint32_t size, uint32_t record_size);
+
+// Acrescenta um registro à página em RAM; false (e contado em dropped) se a página anterior
+// ainda não foi gravada
+bool flashlog_append(flashlog_t *log, const void *record);
+
+// Executa no máximo uma operação de flash pendente (apagar um setor ou gravar uma página);
+// retorna true se alguma operação foi feita
+bool flashlog_task(flashlog_t *log);
+
+// Sequência da página mais antiga que ainda pode estar na flash
+uint32_t flashlog_first_seq(const flashlog_t *log);
+
+static inline uint32_t flashlog_next_seq(const flashlog_t *log) {
+    return log->head;
+}
+
+// Página gravada de sequência seq, lida diretamente da flash; NULL se apagada,
+// sobrescrita ou corrompida
+const flashlog_page_t *flashlog_page(const flashlog_t *log, uint32_t seq);
+
+#endif // FLASHLOG_H
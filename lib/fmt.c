@@ -0,0 +1,98 @@
+#include <stdbool.h>
+
+#include "fmt.h"
+
+static const uint32_t pow10_table[FMT_MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+// escreve os dígitos de value (no mínimo min_digits, com zeros à esquerda)
+static size_t put_digits(char *dst, size_t room, uint32_t value, unsigned min_digits) {
+    char tmp[10];
+    unsigned n = 0;
+    do {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n < min_digits) tmp[n++] = '0';
+    size_t written = 0;
+    while (n && written < room) dst[written++] = tmp[--n];
+    return written;
+}
+
+size_t fmt_fixed(char *dst, size_t cap, int32_t value, unsigned decimals) {
+    if (cap == 0) return 0;
+    if (decimals > FMT_MAX_DECIMALS) decimals = FMT_MAX_DECIMALS;
+    size_t room = cap - 1;
+    size_t len = 0;
+    uint32_t mag = value < 0 ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+    if (value < 0 && len < room) dst[len++] = '-';
+    uint32_t scale = pow10_table[decimals];
+    len += put_digits(dst + len, room - len, mag / scale, 1);
+    if (decimals && len < room) {
+        dst[len++] = '.';
+        len += put_digits(dst + len, room - len, mag % scale, decimals);
+    }
+    dst[len] = '\0';
+    return len;
+}
+
+size_t fmt_int(char *dst, size_t cap, int32_t value) {
+    return fmt_fixed(dst, cap, value, 0);
+}
+
+size_t fmt_uint(char *dst, size_t cap, uint32_t value) {
+    if (cap == 0) return 0;
+    size_t len = put_digits(dst, cap - 1, value, 1);
+    dst[len] = '\0';
+    return len;
+}
+
+size_t fmt_str(char *dst, size_t cap, const char *s) {
+    if (cap == 0) return 0;
+    size_t len = 0;
+    while (s[len] && len < cap - 1) {
+        dst[len] = s[len];
+        len++;
+    }
+    dst[len] = '\0';
+    return len;
+}
+
+int32_t fmt_scale(float value, unsigned decimals) {
+    if (decimals > FMT_MAX_DECIMALS) decimals = FMT_MAX_DECIMALS;
+    float scaled = value * (float)pow10_table[decimals];
+    if (scaled >= 2147483647.0f) return INT32_MAX;
+    if (scaled <= -2147483648.0f) return INT32_MIN;
+    return (int32_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+int32_t fmt_round(int32_t value, unsigned drop) {
+    if (drop > FMT_MAX_DECIMALS) drop = FMT_MAX_DECIMALS;
+    // em 64 bits: somar meia unidade (ou negar INT32_MIN) transbordaria perto dos extremos
+    int64_t v = value, scale = (int64_t)pow10_table[drop];
+    return (int32_t)(v < 0 ? -((-v + scale / 2) / scale) : (v + scale / 2) / scale);
+}
+
+int32_t fmt_parse_fixed(const char *s, unsigned decimals) {
+    if (decimals > FMT_MAX_DECIMALS) decimals = FMT_MAX_DECIMALS;
+    bool negative = *s == '-';
+    if (*s == '-' || *s == '+') s++;
+    int64_t value = 0;
+    for (; *s >= '0' && *s <= '9'; s++) {
+        if (value < INT32_MAX) value = value * 10 + (*s - '0');
+    }
+    unsigned digits = 0;
+    if (*s == '.') {
+        for (s++; *s >= '0' && *s <= '9'; s++) {
+            if (digits < decimals) {
+                value = value * 10 + (*s - '0');
+                digits++;
+            } else {
+                if (digits == decimals && *s >= '5') value++;   // primeira casa descartada arredonda
+                digits = decimals + 1;
+            }
+        }
+    }
+    for (; digits < decimals; digits++) value *= 10;
+    if (value > INT32_MAX) value = INT32_MAX;
+    return (int32_t)(negative ? -value : value);
+}
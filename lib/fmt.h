@@ -0,0 +1,36 @@
+#ifndef FMT_H
+#define FMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Formatação de números em ponto fixo sem printf: o valor chega como inteiro escalado
+// (ex.: 2735 com 2 casas = "27.35") e é escrito direto no buffer do chamador, sem
+// alocação e sem a formatação de float em software do printf (o Cortex-M0+ não tem FPU).
+// Todas as funções escrevem no máximo cap - 1 caracteres, sempre terminam a string
+// (se cap > 0) e retornam quantos caracteres foram escritos, o que permite encadear
+// chamadas com dst + len e cap - len sem ultrapassar o buffer.
+
+#define FMT_MAX_DECIMALS 6
+
+// Escreve value / 10^decimals com exatamente "decimals" casas (decimals <= FMT_MAX_DECIMALS)
+size_t fmt_fixed(char *dst, size_t cap, int32_t value, unsigned decimals);
+
+// Inteiros sem casas decimais
+size_t fmt_int(char *dst, size_t cap, int32_t value);
+size_t fmt_uint(char *dst, size_t cap, uint32_t value);
+
+// Copia uma string (literal ou variável)
+size_t fmt_str(char *dst, size_t cap, const char *s);
+
+// Converte um float para o inteiro escalado por 10^decimals, arredondado ao mais próximo
+int32_t fmt_scale(float value, unsigned decimals);
+
+// Reduz a escala de um valor em "drop" casas decimais, arredondando (metade para longe do zero)
+int32_t fmt_round(int32_t value, unsigned drop);
+
+// Lê um número decimal ("-12.345") como inteiro escalado por 10^decimals; casas além
+// de "decimals" são arredondadas. Para no primeiro caractere que não faz parte do número
+int32_t fmt_parse_fixed(const char *s, unsigned decimals);
+
+#endif // FMT_H
@@ -0,0 +1,29 @@
+#include "history.h"
+
+void history_init(history_t *h, history_record_t *storage, uint32_t capacity) {
+    h->records = storage;
+    h->capacity = capacity;
+    h->next_seq = 1;
+    h->count = 0;
+}
+
+uint32_t history_push(history_t *h, const history_record_t *rec) {
+    uint32_t seq = h->next_seq++;
+    h->records[seq % h->capacity] = *rec;
+    if (h->count < h->capacity) {
+        h->count++;
+    }
+    return seq;
+}
+
+uint32_t history_first_seq(const history_t *h) {
+    return h->next_seq - h->count;
+}
+
+bool history_get(const history_t *h, uint32_t seq, history_record_t *out) {
+    if (seq < history_first_seq(h) || seq >= h->next_seq) {
+        return false;
+    }
+    *out = h->records[seq % h->capacity];
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Histórico das medições em RAM: fila circular de registros compactos em ponto fixo.
+// Cada registro recebe um número de sequência crescente (o primeiro é 1); os clientes
+// pedem apenas os registros posteriores ao último que já possuem.
+
+// pressão guardada como deslocamento sobre 500 hPa para caber em 16 bits (500..1155 hPa)
+#define HISTORY_PRESS_OFFSET_PA 50000
+
+typedef struct {
+    uint32_t timestamp_ms;  // instante da leitura, em ms desde o boot
+    int16_t temp_c100;      // temperatura em centésimos de °C
+    uint16_t umid_c100;     // umidade em centésimos de %
+    uint16_t press_off_pa;  // pressão em Pa menos HISTORY_PRESS_OFFSET_PA
+    int16_t alt_dm;         // altitude em decímetros
+} history_record_t;
+
+typedef struct {
+    history_record_t *records;
+    uint32_t capacity;
+    uint32_t next_seq;      // sequência que o próximo registro receberá
+    uint32_t count;         // registros válidos (até capacity)
+} history_t;
+
+void history_init(history_t *h, history_record_t *storage, uint32_t capacity);
+
+// Acrescenta um registro, sobrescrevendo o mais antigo se cheio; retorna a sequência atribuída
+uint32_t history_push(history_t *h, const history_record_t *rec);
+
+// Sequência do registro mais antigo ainda disponível (igual a history_next_seq se vazio)
+uint32_t history_first_seq(const history_t *h);
+
+static inline uint32_t history_next_seq(const history_t *h) {
+    return h->next_seq;
+}
+
+// Copia o registro de sequência seq; false se já foi sobrescrito ou ainda não existe
+bool history_get(const history_t *h, uint32_t seq, history_record_t *out);
+
+#endif // HISTORY_H
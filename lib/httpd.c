@@ -0,0 +1,1083 @@
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "httpd.h"
+#include "lwip/tcp.h"
+#include "sha1.h"
+
+#define HTTPD_POLL_INTERVAL 2       // tcp_poll em unidades de 500 ms: verificação a cada 1 s
+#define HTTPD_MAX_HEAD 4096         // limite da linha de requisição mais cabeçalhos
+#define HTTPD_TOKEN_SIZE 24         // método, versão ou nome de cabeçalho em leitura
+#define HTTPD_WS_MAX_CONTROL 125    // carga máxima de um quadro de controle (RFC 6455 5.5)
+#define HTTPD_CHUNK_HEAD 8          // reservado em resp.body para o tamanho do trecho ("c00\r\n")
+
+// códigos de fechamento do WebSocket
+#define WS_CLOSE_NORMAL 1000
+#define WS_CLOSE_PROTOCOL 1002
+#define WS_CLOSE_NO_STATUS 1005      // close recebido sem código: a resposta também vai sem
+#define WS_CLOSE_TOO_BIG 1009
+
+// opcodes dos quadros WebSocket
+enum {
+    WS_OP_CONTINUATION = 0x0,
+    WS_OP_TEXT = 0x1,
+    WS_OP_BINARY = 0x2,
+    WS_OP_CLOSE = 0x8,
+    WS_OP_PING = 0x9,
+    WS_OP_PONG = 0xA,
+};
+
+// estados do analisador de requisições
+typedef enum {
+    PARSE_METHOD,
+    PARSE_PATH,
+    PARSE_KEY,
+    PARSE_VALUE,
+    PARSE_VERSION,
+    PARSE_HEADER_START,
+    PARSE_HEADER_NAME,
+    PARSE_HEADER_VALUE,
+    PARSE_BODY,
+    PARSE_DONE,
+} parse_state_t;
+
+typedef struct {
+    struct tcp_pcb *pcb;            // NULL: posição livre
+    struct pbuf *pending;           // dados recebidos ainda não consumidos pelo analisador
+
+    // analisador (reiniciado a cada requisição)
+    uint8_t state;
+    uint8_t pct;                    // dígitos hexadecimais restantes de um %XX
+    uint8_t pct_value;
+    int8_t header;                  // cabeçalho conhecido em leitura, -1 se descartado
+    char token[HTTPD_TOKEN_SIZE];
+    uint8_t token_len;
+    uint8_t value_len;
+    uint16_t path_len;
+    uint16_t query_len;
+    uint16_t head_bytes;
+    uint16_t error;                 // status de erro detectado pelo analisador, 0 se nenhum
+    uint32_t candidates;            // rotas cujo caminho ainda casa com o que chegou
+    int8_t route;                   // rota escolhida, -1 para o fallback
+    uint32_t body_left;
+    httpd_request_t req;
+
+    char head[128];                 // linha de status e cabeçalhos gerados pelo servidor
+    size_t head_len;
+    httpd_response_t resp;
+    size_t total;                   // tamanho da resposta em andamento
+    size_t queued;                  // bytes já entregues ao lwIP
+    size_t acked;                   // bytes confirmados pelo cliente
+    bool busy;                      // resposta em andamento
+    bool close_after;               // fechar ao concluir a resposta em andamento
+    bool finishing;                 // encerrando: fecha quando o cliente confirmar tudo o que foi enviado
+    bool stream;                    // conexão em modo fluxo: não volta a atender requisições
+    bool chunked;                   // corpo gerado vai em chunked (o cliente fala HTTP/1.1)
+    size_t fill_cursor;             // posição de resp.fill no corpo gerado
+    uint8_t idle_s;                 // segundos sem tráfego
+    uint8_t quiet_s;                // segundos sem dados enviados ao fluxo
+    uint16_t requests;              // requisições atendidas nesta conexão
+
+    // WebSocket (após o upgrade): a mensagem em montagem ocupa resp.body, livre neste modo
+    httpd_ws_handler_t ws;          // NULL: conexão HTTP
+    uint8_t ws_hdr[14];             // cabeçalho do quadro em leitura
+    uint8_t ws_hdr_len;
+    uint8_t ws_hdr_need;            // tamanho do cabeçalho, conhecido após os 2 primeiros bytes
+    uint32_t ws_left;               // bytes restantes da carga do quadro
+    uint32_t ws_pos;                // posição na carga (índice da máscara)
+    uint8_t ws_msg_op;              // opcode da mensagem fragmentada em andamento, 0 se nenhuma
+    uint16_t ws_msg_len;
+    uint8_t ws_ctrl_len;
+    uint16_t ws_close;              // código de fechamento a enviar, 0 se nenhum
+} httpd_conn_t;
+
+static_assert(HTTPD_WS_MAX_MESSAGE + HTTPD_WS_MAX_CONTROL <= HTTPD_BODY_SIZE,
+              "mensagem e quadro de controle do WebSocket devem caber em resp.body");
+
+static const httpd_route_t *httpd_routes;
+static size_t httpd_num_routes;
+static httpd_handler_t httpd_fallback;
+static httpd_conn_t httpd_conns[HTTPD_MAX_CONNS];
+static uint32_t httpd_requests;             // requisições atendidas (todas as conexões)
+static uint32_t httpd_rejected;             // conexões recusadas com 503
+static metrics_histogram_t *httpd_recv_latency;
+
+// nomes (em minúsculas) dos cabeçalhos guardados, na ordem de httpd_header_id_t
+static const char *const httpd_header_names[HTTPD_H_COUNT] = {
+    "connection",
+    "content-length",
+    "accept",
+    "accept-encoding",
+    "if-none-match",
+    "upgrade",
+    "sec-websocket-key",
+    "sec-websocket-version",
+};
+
+// resposta às conexões excedentes, enviada da flash sem estado de conexão
+static const char httpd_busy[] =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nRetry-After: 1\r\nConnection: close\r\n\r\n";
+
+static const char *status_text(int status) {
+    switch (status) {
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 414: return "URI Too Long";
+        case 431: return "Request Header Fields Too Large";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+void httpd_status(httpd_response_t *resp, int status) {
+    resp->status = status;
+}
+
+void httpd_header(httpd_response_t *resp, const char *fmt, ...) {
+    size_t cap = sizeof(resp->header) - resp->header_len;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(resp->header + resp->header_len, cap, fmt, ap);
+    va_end(ap);
+    // cabeçalho que não cabe (com o CRLF e a linha vazia final) é descartado inteiro
+    if (n >= 0 && (size_t)n + 4 <= cap) {
+        resp->header_len += (size_t)n;
+        memcpy(resp->header + resp->header_len, "\r\n", 2);
+        resp->header_len += 2;
+    }
+}
+
+const char *httpd_param(const httpd_request_t *req, const char *key) {
+    for (uint8_t i = 0; i < req->num_params; i++) {
+        if (strcmp(req->params[i].key, key) == 0) return req->params[i].value;
+    }
+    return NULL;
+}
+
+bool httpd_has_token(const char *list, const char *token) {
+    size_t len = strlen(token);
+    while (list && *list) {
+        while (*list == ' ' || *list == ',') list++;
+        if (strncasecmp(list, token, len) == 0 && (list[len] == '\0' || list[len] == ',' ||
+                                                   list[len] == ' ' || list[len] == ';')) {
+            return true;
+        }
+        list = strchr(list, ',');
+    }
+    return false;
+}
+
+bool httpd_etag_match(const char *list, const char *etag) {
+    size_t len = strlen(etag);
+    while (list && *list) {
+        while (*list == ' ' || *list == ',') list++;
+        if (*list == '*') return true;
+        if (strncmp(list, "W/", 2) == 0) list += 2;
+        if (*list == '"') {
+            const char *end = strchr(list + 1, '"');
+            if (!end) return false;
+            if ((size_t)(end - list - 1) == len && strncmp(list + 1, etag, len) == 0) return true;
+            list = end + 1;
+        }
+        list = strchr(list, ',');
+    }
+    return false;
+}
+
+// --- Analisador de requisições ---
+static void parse_reset(httpd_conn_t *c) {
+    c->state = PARSE_METHOD;
+    c->pct = 0;
+    c->token_len = 0;
+    c->path_len = 0;
+    c->query_len = 0;
+    c->head_bytes = 0;
+    c->error = 0;
+    c->route = -1;
+    c->body_left = 0;
+    c->req.num_params = 0;
+    c->req.present = 0;
+    c->req.http10 = false;
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+// decodifica %XX (e '+' na query); retorna o caractere decodificado ou -1 se ainda incompleto
+static int decode_char(httpd_conn_t *c, char ch, bool query) {
+    if (c->pct) {
+        int v = hex_value(ch);
+        if (v < 0) {
+            c->error = 400;
+            return -1;
+        }
+        c->pct_value = (uint8_t)(c->pct_value << 4 | v);
+        return --c->pct ? -1 : c->pct_value;
+    }
+    if (ch == '%') {
+        c->pct = 2;
+        c->pct_value = 0;
+        return -1;
+    }
+    return query && ch == '+' ? ' ' : (unsigned char)ch;
+}
+
+// avança a comparação do caminho com a tabela: descarta as rotas que divergem neste caractere
+static void route_char(httpd_conn_t *c, char ch) {
+    if (ch == '\0') {
+        c->error = 400;                         // %00 no caminho: casaria com o fim das rotas
+        c->candidates = 0;
+        return;
+    }
+    for (uint32_t m = c->candidates, i = 0; m; m >>= 1, i++) {
+        if ((m & 1) && httpd_routes[i].path[c->path_len] != ch) c->candidates &= ~(1u << i);
+    }
+    if (c->path_len < UINT16_MAX) c->path_len++;
+}
+
+static void route_end(httpd_conn_t *c) {
+    if (c->pct) c->error = 400;
+    // HEAD usa as rotas GET; httpd_respond omite o corpo
+    httpd_method_t method = c->req.method == HTTPD_HEAD ? HTTPD_GET : c->req.method;
+    for (uint32_t m = c->candidates, i = 0; m; m >>= 1, i++) {
+        if ((m & 1) && httpd_routes[i].path[c->path_len] == '\0' && httpd_routes[i].method == method) {
+            c->route = (int8_t)i;
+            return;
+        }
+    }
+}
+
+static void query_put(httpd_conn_t *c, char ch) {
+    if (c->query_len >= HTTPD_QUERY_SIZE) {
+        c->error = 414;
+        return;
+    }
+    c->req.query[c->query_len++] = ch;
+}
+
+// abre um novo parâmetro cuja chave começa na posição atual do armazenamento da query
+static void param_begin(httpd_conn_t *c) {
+    if (c->req.num_params < HTTPD_MAX_PARAMS) {
+        c->req.params[c->req.num_params].key = c->req.query + c->query_len;
+        c->req.params[c->req.num_params].value = NULL;
+    }
+}
+
+// fecha a chave (ou o valor) em leitura; chaves vazias são descartadas
+static void param_end(httpd_conn_t *c, bool value) {
+    if (c->req.num_params >= HTTPD_MAX_PARAMS) return;
+    httpd_param_t *p = &c->req.params[c->req.num_params];
+    query_put(c, '\0');
+    if (c->error) return;
+    if (!value) {
+        p->value = c->req.query + c->query_len;  // valor começa após o '\0' da chave
+        return;
+    }
+    if (!p->value) {                              // parâmetro sem '=': valor vazio
+        p->value = c->req.query + c->query_len - 1;
+    }
+    if (p->key[0] != '\0') c->req.num_params++;
+}
+
+static void token_put(httpd_conn_t *c, char ch) {
+    if (c->token_len < HTTPD_TOKEN_SIZE - 1) {
+        c->token[c->token_len++] = ch;
+    } else {
+        c->token_len = HTTPD_TOKEN_SIZE;          // longo demais: não casa com nada conhecido
+    }
+}
+
+static void header_name_end(httpd_conn_t *c) {
+    c->header = -1;
+    if (c->token_len < HTTPD_TOKEN_SIZE) {
+        c->token[c->token_len] = '\0';
+        for (int i = 0; i < HTTPD_H_COUNT; i++) {
+            if (strcmp(c->token, httpd_header_names[i]) == 0) c->header = (int8_t)i;
+        }
+    }
+    c->value_len = 0;
+}
+
+static void header_value_end(httpd_conn_t *c) {
+    if (c->header < 0) return;
+    char *value = c->req.headers[c->header];
+    while (c->value_len > 0 && (value[c->value_len - 1] == ' ' || value[c->value_len - 1] == '\t')) c->value_len--;
+    value[c->value_len] = '\0';
+    c->req.present |= 1u << c->header;
+}
+
+static void headers_end(httpd_conn_t *c) {
+    const char *length = httpd_request_header(&c->req, HTTPD_H_CONTENT_LENGTH);
+    c->body_left = length ? (uint32_t)strtoul(length, NULL, 10) : 0;
+    c->state = c->body_left ? PARSE_BODY : PARSE_DONE;
+}
+
+// consome bytes de uma requisição até ela terminar; retorna quantos bytes foram usados
+static size_t httpd_parse(httpd_conn_t *c, const char *data, size_t len) {
+    size_t i = 0;
+    for (; i < len && c->state != PARSE_DONE && !c->error; i++) {
+        char ch = data[i];
+        if (c->state != PARSE_BODY && ++c->head_bytes > HTTPD_MAX_HEAD) {
+            c->error = 431;
+            break;
+        }
+        int dc;
+        switch (c->state) {
+            case PARSE_METHOD:
+                if (ch == ' ') {
+                    c->token[c->token_len < HTTPD_TOKEN_SIZE ? c->token_len : 0] = '\0';
+                    c->req.method = strcmp(c->token, "GET") == 0    ? HTTPD_GET
+                                    : strcmp(c->token, "HEAD") == 0 ? HTTPD_HEAD
+                                    : strcmp(c->token, "POST") == 0 ? HTTPD_POST
+                                                                    : HTTPD_OTHER;
+                    c->candidates = httpd_num_routes >= 32 ? UINT32_MAX : (1u << httpd_num_routes) - 1;
+                    c->state = PARSE_PATH;
+                } else if (ch == '\r' || ch == '\n') {
+                    if (c->token_len) c->error = 400;  // linhas vazias antes da requisição são toleradas
+                } else {
+                    token_put(c, ch);
+                }
+                break;
+            case PARSE_PATH:
+                if (ch == ' ' || ch == '?') {
+                    route_end(c);
+                    if (ch == '?') param_begin(c);
+                    c->token_len = 0;
+                    c->state = ch == '?' ? PARSE_KEY : PARSE_VERSION;
+                } else if (ch == '\r' || ch == '\n') {
+                    c->error = 400;
+                } else if ((dc = decode_char(c, ch, false)) >= 0) {
+                    route_char(c, (char)dc);
+                }
+                break;
+            case PARSE_KEY:
+            case PARSE_VALUE:
+                if (ch == '&' || ch == ' ') {
+                    if (c->state == PARSE_KEY) param_end(c, false);
+                    param_end(c, true);
+                    if (ch == '&') {
+                        param_begin(c);
+                        c->state = PARSE_KEY;
+                    } else {
+                        c->state = PARSE_VERSION;
+                    }
+                } else if (ch == '=' && c->state == PARSE_KEY) {
+                    param_end(c, false);
+                    c->state = PARSE_VALUE;
+                } else if (ch == '\r' || ch == '\n') {
+                    c->error = 400;
+                } else if (c->req.num_params < HTTPD_MAX_PARAMS && (dc = decode_char(c, ch, true)) >= 0) {
+                    query_put(c, (char)dc);
+                }
+                break;
+            case PARSE_VERSION:
+                if (ch == '\n') {
+                    c->token[c->token_len < HTTPD_TOKEN_SIZE ? c->token_len : 0] = '\0';
+                    if (strncmp(c->token, "HTTP/1.", 7) != 0) c->error = 400;
+                    c->req.http10 = strcmp(c->token, "HTTP/1.0") == 0;
+                    c->state = PARSE_HEADER_START;
+                } else if (ch != '\r') {
+                    token_put(c, ch);
+                }
+                break;
+            case PARSE_HEADER_START:
+                if (ch == '\n') {
+                    headers_end(c);
+                    break;
+                }
+                if (ch == '\r') break;
+                c->token_len = 0;
+                c->state = PARSE_HEADER_NAME;
+                /* fall through */
+            case PARSE_HEADER_NAME:
+                if (ch == ':') {
+                    header_name_end(c);
+                    c->state = PARSE_HEADER_VALUE;
+                } else if (ch == '\n') {
+                    c->error = 400;
+                } else if (ch != '\r') {
+                    token_put(c, (char)(ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch));
+                }
+                break;
+            case PARSE_HEADER_VALUE:
+                if (ch == '\n') {
+                    header_value_end(c);
+                    c->state = PARSE_HEADER_START;
+                } else if (ch == '\r' || ((ch == ' ' || ch == '\t') && c->value_len == 0)) {
+                    // espaços iniciais e o CR do fim de linha não fazem parte do valor
+                } else if (c->header >= 0 && c->value_len < HTTPD_HEADER_VALUE_SIZE - 1) {
+                    c->req.headers[c->header][c->value_len++] = ch;
+                }
+                break;
+            case PARSE_BODY:
+                // corpo não é usado por nenhuma rota: apenas descartado
+                if (--c->body_left == 0) c->state = PARSE_DONE;
+                break;
+        }
+    }
+    return i;
+}
+
+// --- Conexões ---
+static void httpd_drop_pending(httpd_conn_t *c) {
+    if (c->pending) {
+        pbuf_free(c->pending);
+        c->pending = NULL;
+    }
+}
+
+// libera a conexão; retorna ERR_ABRT se o pcb foi abortado (valor a devolver ao lwIP).
+// Dados ainda não confirmados podem apontar sem cópia para os buffers desta posição, que
+// será reaproveitada: nesse caso o pcb é abortado, descartando os segmentos do lwIP
+static err_t httpd_close(httpd_conn_t *c, bool abort) {
+    tcp_arg(c->pcb, NULL);
+    tcp_recv(c->pcb, NULL);
+    tcp_sent(c->pcb, NULL);
+    tcp_poll(c->pcb, NULL, 0);
+    tcp_err(c->pcb, NULL);
+    err_t ret = ERR_OK;
+    if (abort || c->acked < c->total || tcp_close(c->pcb) != ERR_OK) {
+        tcp_abort(c->pcb);
+        ret = ERR_ABRT;
+    }
+    httpd_drop_pending(c);
+    c->pcb = NULL;                              // devolve a posição ao conjunto
+    return ret;
+}
+
+// fecha a conexão assim que o cliente confirmar o que já foi enfileirado (em httpd_sent);
+// até lá o que chegar é descartado e nada mais é enviado
+static err_t httpd_finish(httpd_conn_t *c) {
+    httpd_drop_pending(c);
+    if (c->acked >= c->total) return httpd_close(c, false);
+    c->finishing = true;
+    return ERR_OK;
+}
+
+// entrega ao lwIP o próximo trecho de [head][header][body][static_body] que couber em
+// tcp_sndbuf, sem cópia: os buffers vivem na conexão até a confirmação e o corpo constante na flash
+static void httpd_enqueue(httpd_conn_t *c) {
+    const void *seg[4] = { c->head, c->resp.header, c->resp.body, c->resp.static_body };
+    size_t seg_len[4] = { c->head_len, c->resp.header_len, c->resp.body_len, c->resp.static_len };
+    size_t start = 0;
+    for (int i = 0; i < 4 && c->queued < c->total; start += seg_len[i], i++) {
+        while (c->queued < start + seg_len[i]) {
+            size_t chunk = tcp_sndbuf(c->pcb);
+            if (chunk == 0) goto out;           // o restante segue a partir de httpd_sent
+            size_t left = start + seg_len[i] - c->queued;
+            if (chunk > left) chunk = left;
+            u8_t flags = c->queued + chunk < c->total ? TCP_WRITE_FLAG_MORE : 0;
+            if (tcp_write(c->pcb, (const char *)seg[i] + (c->queued - start), (u16_t)chunk, flags) != ERR_OK) {
+                goto out;                       // fila do lwIP cheia: nova tentativa em httpd_sent/httpd_poll
+            }
+            c->queued += chunk;
+        }
+    }
+out:
+    tcp_output(c->pcb);
+}
+
+// gera o próximo trecho de resp.fill em resp.body, com o enquadramento do chunked
+// ("<tamanho hex>\r\n<dados>\r\n"); o corpo termina com o trecho vazio
+static void httpd_fill(httpd_conn_t *c) {
+    httpd_response_t *r = &c->resp;
+    size_t head = c->chunked ? HTTPD_CHUNK_HEAD : 0;
+    size_t len = r->fill(r->body + head, sizeof(r->body) - head - 2, &c->fill_cursor);
+    if (len == 0) r->fill = NULL;
+    if (!c->chunked) {
+        r->body_len = len;
+        return;
+    }
+    char size[HTTPD_CHUNK_HEAD];
+    int n = snprintf(size, sizeof(size), "%x\r\n", (unsigned)len);
+    memmove(r->body + n, r->body + head, len);
+    memcpy(r->body, size, (size_t)n);
+    memcpy(r->body + n + len, "\r\n", 2);
+    r->body_len = (size_t)n + len + 2;
+}
+
+// trecho anterior do corpo gerado confirmado: o próximo reaproveita resp.body
+static void httpd_next_chunk(httpd_conn_t *c) {
+    httpd_fill(c);
+    c->head_len = 0;
+    c->resp.header_len = 0;
+    c->total = c->resp.body_len;
+    c->queued = 0;
+    c->acked = 0;
+}
+
+// monta a linha de status e os cabeçalhos gerados pelo servidor e inicia o envio
+static void httpd_respond(httpd_conn_t *c) {
+    httpd_response_t *r = &c->resp;
+    r->header[r->header_len++] = '\r';
+    r->header[r->header_len++] = '\n';
+
+    bool has_body = r->status != 304 && r->status != 204;
+    size_t body_len = r->static_body ? r->static_len : r->body_len;
+    if (r->static_body) r->body_len = 0;
+    int n = snprintf(c->head, sizeof(c->head), "HTTP/1.1 %d %s\r\n", r->status, status_text(r->status));
+    if (has_body && !r->stream && !c->ws && !r->fill) {
+        n += snprintf(c->head + n, sizeof(c->head) - n, "Content-Length: %u\r\n", (unsigned)body_len);
+    }
+    if (r->fill && c->chunked) n += snprintf(c->head + n, sizeof(c->head) - n, "Transfer-Encoding: chunked\r\n");
+    if (c->ws) {
+        n += snprintf(c->head + n, sizeof(c->head) - n, "Connection: Upgrade\r\n");
+    } else if (r->stream) {
+        // o corpo termina com o fechamento da conexão: sem Content-Length nem Keep-Alive
+    } else if (c->close_after) {
+        n += snprintf(c->head + n, sizeof(c->head) - n, "Connection: close\r\n");
+    } else {
+        n += snprintf(c->head + n, sizeof(c->head) - n, "Connection: keep-alive\r\nKeep-Alive: timeout=%d, max=%d\r\n",
+                      HTTPD_IDLE_TIMEOUT_S, HTTPD_MAX_REQUESTS - c->requests);
+    }
+    c->head_len = (size_t)n;
+
+    // corpo gerado: o primeiro trecho já segue com os cabeçalhos
+    if (r->fill) {
+        if (c->req.method == HTTPD_HEAD) {
+            r->fill = NULL;
+        } else {
+            httpd_fill(c);
+        }
+    }
+
+    // HEAD: os mesmos cabeçalhos (inclusive Content-Length) do GET, sem o corpo
+    c->total = c->head_len + r->header_len;
+    if (c->req.method != HTTPD_HEAD) c->total += r->body_len + r->static_len;
+    c->queued = 0;
+    c->acked = 0;
+    c->busy = true;
+    httpd_enqueue(c);
+}
+
+static void response_reset(httpd_response_t *r, int status) {
+    r->status = status;
+    r->header_len = 0;
+    r->body_len = 0;
+    r->static_body = NULL;
+    r->static_len = 0;
+    r->fill = NULL;
+    r->stream = false;
+    r->websocket = NULL;
+}
+
+// resposta de erro gerada pelo próprio servidor, seguida do fechamento da conexão
+static void httpd_error(httpd_conn_t *c, int status) {
+    response_reset(&c->resp, status);
+    c->close_after = true;
+    httpd_drop_pending(c);
+    httpd_respond(c);
+}
+
+// entrega a requisição completa ao handler da rota e inicia a resposta
+static void httpd_dispatch(httpd_conn_t *c) {
+    const char *connection = httpd_request_header(&c->req, HTTPD_H_CONNECTION);
+    c->close_after = c->requests + 1 >= HTTPD_MAX_REQUESTS || httpd_has_token(connection, "close") ||
+                     (c->req.http10 && !httpd_has_token(connection, "keep-alive"));
+
+    response_reset(&c->resp, 200);
+    if (c->route >= 0) {
+        httpd_routes[c->route].handler(&c->req, &c->resp);
+    } else {
+        httpd_fallback(&c->req, &c->resp);
+    }
+    c->requests++;
+    httpd_requests++;
+    // HEAD de um fluxo: só os cabeçalhos, e a conexão fecha como fecharia o fluxo
+    c->stream = c->resp.stream && c->req.method != HTTPD_HEAD;
+    if (c->resp.stream && !c->stream) c->close_after = true;
+    // corpo gerado para um cliente HTTP/1.0: sem chunked, termina com o fechamento
+    c->chunked = !c->req.http10;
+    if (c->resp.fill && c->req.http10) c->close_after = true;
+    c->fill_cursor = 0;
+    c->ws = c->resp.status == 101 ? c->resp.websocket : NULL;
+    c->ws_hdr_len = 0;
+    c->ws_hdr_need = 2;
+    c->ws_msg_op = 0;
+    c->ws_close = 0;
+    c->quiet_s = 0;
+    parse_reset(c);
+    httpd_respond(c);
+}
+
+// --- Fluxos e WebSocket ---
+// entrega a + b ao lwIP como cópia, inteiros ou nada; só depois da resposta inicial.
+// As duas partes são juntadas antes, num único tcp_write: um segundo tcp_write recusado
+// (fila de segmentos cheia) deixaria um cabeçalho de quadro sem a carga
+static bool conn_write(httpd_conn_t *c, const void *a, size_t a_len, const void *b, size_t b_len) {
+    static uint8_t joined[HTTPD_SEND_MAX];
+    if (c->finishing || c->queued < c->total || a_len + b_len > tcp_sndbuf(c->pcb)) return false;
+    if (b_len) {
+        if (a_len + b_len > sizeof(joined)) return false;
+        memcpy(joined, a, a_len);
+        memcpy(joined + a_len, b, b_len);
+        a = joined;
+    }
+    if (tcp_write(c->pcb, a, (u16_t)(a_len + b_len), TCP_WRITE_FLAG_COPY) != ERR_OK) return false;
+    tcp_output(c->pcb);
+    c->queued += a_len + b_len;
+    c->total += a_len + b_len;
+    c->quiet_s = 0;
+    return true;
+}
+
+// conexões que não voltam a atender requisições (fluxos e WebSockets)
+static int long_lived_count(void) {
+    int open = 0;
+    for (int i = 0; i < HTTPD_MAX_CONNS; i++) {
+        if (httpd_conns[i].pcb && (httpd_conns[i].stream || httpd_conns[i].ws)) open++;
+    }
+    return open;
+}
+
+bool httpd_stream(httpd_response_t *resp) {
+    int open = 0;
+    for (int i = 0; i < HTTPD_MAX_CONNS; i++) {
+        if (httpd_conns[i].pcb && httpd_conns[i].stream) open++;
+    }
+    if (open >= HTTPD_MAX_STREAMS || long_lived_count() >= HTTPD_MAX_LONG_LIVED) return false;
+    resp->stream = true;
+    return true;
+}
+
+int httpd_stream_broadcast(const void *data, size_t len) {
+    int sent = 0;
+    for (int i = 0; i < HTTPD_MAX_CONNS; i++) {
+        httpd_conn_t *c = &httpd_conns[i];
+        if (c->pcb && c->stream && conn_write(c, data, len, NULL, 0)) sent++;
+    }
+    return sent;
+}
+
+static void base64_encode(char *dst, const uint8_t *src, size_t len) {
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)src[i] << 16 | (i + 1 < len ? src[i + 1] << 8 : 0) | (i + 2 < len ? src[i + 2] : 0);
+        *dst++ = digits[v >> 18];
+        *dst++ = digits[(v >> 12) & 63];
+        *dst++ = i + 1 < len ? digits[(v >> 6) & 63] : '=';
+        *dst++ = i + 2 < len ? digits[v & 63] : '=';
+    }
+    *dst = '\0';
+}
+
+bool httpd_websocket(const httpd_request_t *req, httpd_response_t *resp, httpd_ws_handler_t on_message) {
+    const char *key = httpd_request_header(req, HTTPD_H_SEC_WEBSOCKET_KEY);
+    const char *version = httpd_request_header(req, HTTPD_H_SEC_WEBSOCKET_VERSION);
+    if (req->method != HTTPD_GET || req->http10 || !key ||
+        !httpd_has_token(httpd_request_header(req, HTTPD_H_UPGRADE), "websocket") ||
+        !httpd_has_token(httpd_request_header(req, HTTPD_H_CONNECTION), "upgrade")) {
+        httpd_status(resp, 400);
+        return false;
+    }
+    if (!version || strcmp(version, "13") != 0) {
+        httpd_status(resp, 400);
+        httpd_header(resp, "Sec-WebSocket-Version: 13");
+        return false;
+    }
+    int open = 0;
+    for (int i = 0; i < HTTPD_MAX_CONNS; i++) {
+        if (httpd_conns[i].pcb && httpd_conns[i].ws) open++;
+    }
+    if (open >= HTTPD_MAX_WEBSOCKETS || long_lived_count() >= HTTPD_MAX_LONG_LIVED) {
+        httpd_status(resp, 503);
+        httpd_header(resp, "Retry-After: 5");
+        return false;
+    }
+
+    // Sec-WebSocket-Accept = base64(SHA-1(chave + GUID fixo da RFC 6455))
+    static const char guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    char accept[32];
+    sha1_t sha;
+    sha1_init(&sha);
+    sha1_update(&sha, key, strlen(key));
+    sha1_update(&sha, guid, sizeof(guid) - 1);
+    sha1_final(&sha, digest);
+    base64_encode(accept, digest, sizeof(digest));
+
+    httpd_status(resp, 101);
+    httpd_header(resp, "Upgrade: websocket");
+    httpd_header(resp, "Sec-WebSocket-Accept: %s", accept);
+    resp->websocket = on_message;
+    return true;
+}
+
+// envia um quadro completo (sem máscara, como exige a RFC para o servidor)
+static bool ws_send_frame(httpd_conn_t *c, uint8_t opcode, const void *data, size_t len) {
+    uint8_t hdr[4] = { (uint8_t)(0x80 | opcode) };
+    size_t hdr_len = 2;
+    if (len < 126) {
+        hdr[1] = (uint8_t)len;
+    } else {
+        hdr[1] = 126;
+        hdr[2] = (uint8_t)(len >> 8);
+        hdr[3] = (uint8_t)len;
+        hdr_len = 4;
+    }
+    return conn_write(c, hdr, hdr_len, data, len);
+}
+
+bool httpd_ws_send(int id, const void *data, size_t len, bool binary) {
+    if (id < 0 || id >= HTTPD_MAX_CONNS || len > UINT16_MAX) return false;
+    httpd_conn_t *c = &httpd_conns[id];
+    if (!c->pcb || !c->ws || c->ws_close) return false;
+    return ws_send_frame(c, binary ? WS_OP_BINARY : WS_OP_TEXT, data, len);
+}
+
+int httpd_ws_broadcast(const void *data, size_t len, bool binary) {
+    int sent = 0;
+    for (int i = 0; i < HTTPD_MAX_CONNS; i++) {
+        if (httpd_ws_send(i, data, len, binary)) sent++;
+    }
+    return sent;
+}
+
+// inicia o fechamento: o quadro close com o código segue e a conexão é encerrada
+static void ws_fail(httpd_conn_t *c, uint16_t code) {
+    if (!c->ws_close) c->ws_close = code;
+}
+
+// cabeçalho completo: valida o quadro e prepara a leitura da carga
+static void ws_frame_begin(httpd_conn_t *c) {
+    uint8_t op = c->ws_hdr[0] & 0x0F;
+    bool fin = c->ws_hdr[0] & 0x80;
+    uint64_t len = c->ws_hdr[1] & 0x7F;
+    if (len == 126) {
+        len = (uint32_t)c->ws_hdr[2] << 8 | c->ws_hdr[3];
+    } else if (len == 127) {
+        len = 0;
+        for (int i = 2; i < 10; i++) len = len << 8 | c->ws_hdr[i];
+    }
+    c->ws_left = len > UINT32_MAX ? UINT32_MAX : (uint32_t)len;
+    c->ws_pos = 0;
+    c->ws_ctrl_len = 0;
+
+    if (!(c->ws_hdr[1] & 0x80) || (c->ws_hdr[0] & 0x70)) {
+        ws_fail(c, WS_CLOSE_PROTOCOL);          // cliente deve mascarar; sem extensões negociadas
+    } else if (op >= WS_OP_CLOSE) {
+        if (!fin || len > HTTPD_WS_MAX_CONTROL || op > WS_OP_PONG) ws_fail(c, WS_CLOSE_PROTOCOL);
+    } else if (op == WS_OP_CONTINUATION ? !c->ws_msg_op : (c->ws_msg_op || op > WS_OP_BINARY)) {
+        ws_fail(c, WS_CLOSE_PROTOCOL);          // continuação sem mensagem ou mensagem intercalada
+    } else {
+        if (op != WS_OP_CONTINUATION) {
+            c->ws_msg_op = op;
+            c->ws_msg_len = 0;
+        }
+        if (c->ws_msg_len + len > HTTPD_WS_MAX_MESSAGE) ws_fail(c, WS_CLOSE_TOO_BIG);
+    }
+}
+
+// carga completa: entrega a mensagem ou responde ao quadro de controle
+static void ws_frame_end(httpd_conn_t *c, int id) {
+    uint8_t op = c->ws_hdr[0] & 0x0F;
+    uint8_t *ctrl = (uint8_t *)c->resp.body + HTTPD_WS_MAX_MESSAGE;
+    if (op == WS_OP_PING) {
+        ws_send_frame(c, WS_OP_PONG, ctrl, c->ws_ctrl_len);
+    } else if (op == WS_OP_CLOSE) {
+        // o cliente iniciou o fechamento: o código recebido é devolvido (RFC 6455 5.5.1)
+        uint16_t code = c->ws_ctrl_len >= 2 ? (uint16_t)(ctrl[0] << 8 | ctrl[1]) : WS_CLOSE_NO_STATUS;
+        bool valid = c->ws_ctrl_len == 0 ||
+                     (c->ws_ctrl_len >= 2 && code >= 1000 && code < 5000 && code != 1004 && code != 1005 &&
+                      code != 1006 && (code <= 1014 || code >= 3000));
+        ws_fail(c, valid ? code : WS_CLOSE_PROTOCOL);
+    } else if (op != WS_OP_PONG && (c->ws_hdr[0] & 0x80)) {
+        uint8_t msg_op = c->ws_msg_op;
+        c->ws_msg_op = 0;
+        c->ws(id, (const uint8_t *)c->resp.body, c->ws_msg_len, msg_op == WS_OP_BINARY);
+    }
+}
+
+// consome bytes de quadros WebSocket; retorna quantos foram usados
+static size_t ws_parse(httpd_conn_t *c, const uint8_t *data, size_t len) {
+    int id = (int)(c - httpd_conns);
+    size_t i = 0;
+    while (i < len && !c->ws_close) {
+        if (c->ws_hdr_len < c->ws_hdr_need) {
+            c->ws_hdr[c->ws_hdr_len++] = data[i++];
+            if (c->ws_hdr_len == 2) {
+                uint8_t code = c->ws_hdr[1] & 0x7F;
+                c->ws_hdr_need = (uint8_t)(2 + (code == 126 ? 2 : code == 127 ? 8 : 0) + 4);
+            }
+            if (c->ws_hdr_len < c->ws_hdr_need) continue;
+            ws_frame_begin(c);
+            if (c->ws_close || c->ws_left) continue;
+        } else {
+            // carga: desmascara direto para a mensagem (ou o buffer de controle)
+            const uint8_t *mask = c->ws_hdr + c->ws_hdr_need - 4;
+            size_t n = len - i < c->ws_left ? len - i : c->ws_left;
+            bool control = (c->ws_hdr[0] & 0x0F) >= WS_OP_CLOSE;
+            uint8_t *dst = control ? (uint8_t *)c->resp.body + HTTPD_WS_MAX_MESSAGE + c->ws_ctrl_len
+                                   : (uint8_t *)c->resp.body + c->ws_msg_len;
+            for (size_t k = 0; k < n; k++) dst[k] = data[i + k] ^ mask[(c->ws_pos + k) & 3];
+            if (control) {
+                c->ws_ctrl_len += (uint8_t)n;
+            } else {
+                c->ws_msg_len += (uint16_t)n;
+            }
+            c->ws_pos += (uint32_t)n;
+            c->ws_left -= (uint32_t)n;
+            i += n;
+            if (c->ws_left) continue;
+        }
+        ws_frame_end(c, id);
+        c->ws_hdr_len = 0;
+        c->ws_hdr_need = 2;
+    }
+    return i;
+}
+
+// consome os quadros pendentes; retorna ERR_ABRT se a conexão foi abortada
+static err_t ws_process(httpd_conn_t *c) {
+    while (c->pending && !c->ws_close) {
+        size_t n = ws_parse(c, (const uint8_t *)c->pending->payload, c->pending->len);
+        c->pending = pbuf_free_header(c->pending, (u16_t)n);
+        tcp_recved(c->pcb, (u16_t)n);
+    }
+    if (!c->ws_close) return ERR_OK;
+    uint8_t code[2] = { (uint8_t)(c->ws_close >> 8), (uint8_t)c->ws_close };
+    ws_send_frame(c, WS_OP_CLOSE, code, c->ws_close == WS_CLOSE_NO_STATUS ? 0 : sizeof(code));
+    return httpd_finish(c);                     // o quadro close já está na fila do lwIP
+}
+
+// analisa os dados pendentes até completar uma requisição, se não houver resposta em andamento
+static err_t httpd_process(httpd_conn_t *c) {
+    while (!c->busy) {
+        if (c->state == PARSE_DONE) {
+            httpd_dispatch(c);
+            // bytes que chegaram junto com o pedido de upgrade já são quadros
+            if (c->ws) return ws_process(c);
+            break;
+        }
+        if (!c->pending || c->pending->len == 0) break;
+        size_t n = httpd_parse(c, (const char *)c->pending->payload, c->pending->len);
+        c->pending = pbuf_free_header(c->pending, (u16_t)n);
+        tcp_recved(c->pcb, (u16_t)n);
+        if (c->error) {
+            httpd_error(c, c->error);
+            break;
+        }
+    }
+    return ERR_OK;
+}
+
+static err_t httpd_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    (void)tpcb;
+    httpd_conn_t *c = arg;
+    c->acked += len;
+    c->idle_s = 0;
+    if (c->resp.fill && c->acked >= c->total) httpd_next_chunk(c);
+    if (c->queued < c->total) {
+        httpd_enqueue(c);                       // abriu espaço no buffer de envio: próximo trecho
+    } else if (c->finishing) {
+        if (c->acked >= c->total) return httpd_close(c, false);
+    } else if (c->acked >= c->total && !c->stream && !c->ws) {
+        c->busy = false;
+        if (c->close_after) return httpd_close(c, false);
+        return httpd_process(c);                // próxima requisição enfileirada pelo cliente
+    }
+    return ERR_OK;
+}
+
+static err_t httpd_recv_process(httpd_conn_t *c, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (!p) {
+        // o cliente encerrou o envio: não há mais requisições a atender, mas a resposta em
+        // andamento ainda precisa chegar inteira
+        return httpd_finish(c);
+    }
+    if (err != ERR_OK || c->finishing) {
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        return err != ERR_OK ? httpd_close(c, true) : ERR_OK;
+    }
+    if (c->ws) {
+        if (c->pending) {
+            pbuf_cat(c->pending, p);
+        } else {
+            c->pending = p;
+        }
+        c->idle_s = 0;
+        return ws_process(c);
+    }
+    if (c->stream) {
+        // um fluxo não atende novas requisições: o que o cliente enviar é descartado
+        tcp_recved(tpcb, p->tot_len);
+        pbuf_free(p);
+        return ERR_OK;
+    }
+    // os bytes só são confirmados (tcp_recved) à medida que o analisador os consome,
+    // então requisições em sequência fecham a janela em vez de ocupar memória da aplicação
+    if (c->pending) {
+        pbuf_cat(c->pending, p);
+    } else {
+        c->pending = p;
+    }
+    c->idle_s = 0;
+    return httpd_process(c);
+}
+
+static err_t httpd_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    if (!httpd_recv_latency) return httpd_recv_process(arg, tpcb, p, err);
+    uint64_t start = metrics_start();
+    err_t result = httpd_recv_process(arg, tpcb, p, err);
+    metrics_stop(httpd_recv_latency, start);
+    return result;
+}
+
+// comentário do text/event-stream, ignorado pelo cliente; mantém viva a conexão sem eventos
+static const char httpd_stream_keepalive[] = ":\n\n";
+
+static err_t httpd_poll(void *arg, struct tcp_pcb *tpcb) {
+    (void)tpcb;
+    httpd_conn_t *c = arg;
+    if (c->stream || c->ws) {
+        // um fluxo só é ocioso se o cliente deixou de confirmar o que foi enviado
+        if (c->acked >= c->queued) c->idle_s = 0;
+        if (++c->quiet_s >= HTTPD_STREAM_KEEPALIVE_S) {
+            if (c->ws) {
+                ws_send_frame(c, WS_OP_PING, NULL, 0);
+            } else {
+                conn_write(c, httpd_stream_keepalive, sizeof(httpd_stream_keepalive) - 1, NULL, 0);
+            }
+        }
+    }
+    if (++c->idle_s >= HTTPD_IDLE_TIMEOUT_S) {
+        // ociosa (ou sem confirmações do cliente) por tempo demais
+        return httpd_close(c, c->busy);
+    }
+    if (c->busy && c->queued < c->total) httpd_enqueue(c);
+    return ERR_OK;
+}
+
+static void httpd_err(void *arg, err_t err) {
+    (void)err;
+    httpd_conn_t *c = arg;
+    httpd_drop_pending(c);
+    c->pcb = NULL;                              // o pcb já foi liberado pelo lwIP
+}
+
+// conexões recusadas: descartam o que chegar e fecham quando o 503 for confirmado
+static err_t httpd_busy_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+    (void)arg;
+    (void)err;
+    if (!p) {
+        tcp_recv(tpcb, NULL);
+        if (tcp_close(tpcb) != ERR_OK) {
+            tcp_abort(tpcb);
+            return ERR_ABRT;
+        }
+        return ERR_OK;
+    }
+    tcp_recved(tpcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static err_t httpd_busy_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    (void)arg;
+    (void)len;
+    tcp_recv(tpcb, NULL);
+    tcp_sent(tpcb, NULL);
+    tcp_poll(tpcb, NULL, 0);
+    if (tcp_close(tpcb) != ERR_OK) {
+        tcp_abort(tpcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+static err_t httpd_busy_poll(void *arg, struct tcp_pcb *tpcb) {
+    (void)arg;
+    tcp_abort(tpcb);                            // o cliente não confirmou o 503 a tempo
+    return ERR_ABRT;
+}
+
+static err_t httpd_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+    (void)arg;
+    if (err != ERR_OK || !newpcb) return ERR_VAL;
+    httpd_conn_t *c = NULL;
+    for (int i = 0; i < HTTPD_MAX_CONNS && !c; i++) {
+        if (!httpd_conns[i].pcb) c = &httpd_conns[i];
+    }
+    if (!c) {
+        httpd_rejected++;
+        tcp_arg(newpcb, NULL);
+        tcp_recv(newpcb, httpd_busy_recv);
+        tcp_sent(newpcb, httpd_busy_sent);
+        tcp_poll(newpcb, httpd_busy_poll, 2 * HTTPD_POLL_INTERVAL);
+        if (tcp_write(newpcb, httpd_busy, sizeof(httpd_busy) - 1, 0) != ERR_OK) {
+            tcp_abort(newpcb);
+            return ERR_ABRT;
+        }
+        tcp_output(newpcb);
+        return ERR_OK;
+    }
+    c->pcb = newpcb;
+    c->pending = NULL;
+    c->busy = false;
+    c->close_after = false;
+    c->finishing = false;
+    c->total = 0;
+    c->acked = 0;
+    c->queued = 0;
+    c->stream = false;
+    c->ws = NULL;
+    c->idle_s = 0;
+    c->requests = 0;
+    parse_reset(c);
+    tcp_arg(newpcb, c);
+    tcp_recv(newpcb, httpd_recv);
+    tcp_sent(newpcb, httpd_sent);
+    tcp_poll(newpcb, httpd_poll, HTTPD_POLL_INTERVAL);
+    tcp_err(newpcb, httpd_err);
+    return ERR_OK;
+}
+
+bool httpd_init(uint16_t port, const httpd_route_t *routes, size_t num_routes, httpd_handler_t fallback) {
+    if (num_routes > HTTPD_MAX_ROUTES) return false;
+    httpd_routes = routes;
+    httpd_num_routes = num_routes;
+    httpd_fallback = fallback;
+    struct tcp_pcb *pcb = tcp_new();
+    if (!pcb || tcp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+        return false;
+    }
+    pcb = tcp_listen(pcb);
+    if (!pcb) return false;
+    tcp_accept(pcb, httpd_accept);
+    return true;
+}
+
+void httpd_set_metrics(metrics_histogram_t *recv_latency) {
+    httpd_recv_latency = recv_latency;
+}
+
+void httpd_get_stats(httpd_stats_t *stats) {
+    *stats = (httpd_stats_t){
+        .requests = httpd_requests,
+        .rejected = httpd_rejected,
+        .state_capacity = sizeof(httpd_conns),
+    };
+    for (int i = 0; i < HTTPD_MAX_CONNS; i++) {
+        const httpd_conn_t *c = &httpd_conns[i];
+        if (!c->pcb) continue;
+        stats->connections++;
+        if (c->stream) stats->streams++;
+        if (c->ws) stats->websockets++;
+    }
+    stats->state_bytes = stats->connections * (uint32_t)sizeof(httpd_conn_t);
+}
@@ -0,0 +1,192 @@
+#ifndef HTTPD_H
+#define HTTPD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "metrics.h"
+
+// Servidor HTTP/1.1 sobre a API raw TCP do lwIP.
+// As conexões permanecem abertas entre requisições (keep-alive) até o cliente pedir
+// "Connection: close", ficar HTTPD_IDLE_TIMEOUT_S sem enviar nada ou atingir
+// HTTPD_MAX_REQUESTS requisições. Requisições enviadas em sequência sem esperar as
+// respostas (pipelining) ficam nos pbufs recebidos e são atendidas em ordem, uma
+// de cada vez. Deve ser usado apenas no núcleo que atende a rede; fora dos handlers e
+// callbacks (que já rodam no contexto do lwIP), as funções de envio exigem o lwIP travado
+// com cyw43_arch_lwip_begin/end.
+// O estado das conexões vem de um conjunto fixo de HTTPD_MAX_CONNS posições alocadas
+// estaticamente; com todas ocupadas, uma nova conexão recebe 503 e é fechada.
+// A requisição é analisada byte a byte direto dos pbufs, em qualquer fragmentação:
+// o caminho é comparado com a tabela de rotas enquanto chega, os parâmetros da query
+// são decodificados numa única passagem e só os cabeçalhos conhecidos são guardados.
+// Um handler pode transformar a resposta num fluxo (httpd_stream): a conexão fica aberta
+// após os cabeçalhos e recebe os dados enviados depois com httpd_stream_broadcast, como
+// em text/event-stream. Um corpo maior que resp->body pode ser gerado em trechos
+// (httpd_generated_body), enviados com Transfer-Encoding: chunked. Uma rota também pode
+// aceitar o upgrade para WebSocket (RFC 6455, httpd_websocket): as mensagens recebidas vão
+// para um callback e o envio é feito com httpd_ws_send/httpd_ws_broadcast; pings recebidos
+// são respondidos pelo próprio servidor.
+
+#define HTTPD_MAX_CONNS 4           // conexões atendidas simultaneamente
+#define HTTPD_QUERY_SIZE 160        // chaves e valores decodificados da query
+#define HTTPD_MAX_PARAMS 8          // parâmetros da query
+#define HTTPD_HEADER_VALUE_SIZE 64  // valor guardado de cada cabeçalho conhecido
+#define HTTPD_HEADER_SIZE 256       // cabeçalhos adicionados pelo handler
+#define HTTPD_BODY_SIZE 3072        // corpo dinâmico da resposta (ou cada trecho de um corpo gerado)
+#define HTTPD_MAX_ROUTES 32         // rotas na tabela (máscara de candidatas de 32 bits)
+#define HTTPD_IDLE_TIMEOUT_S 15     // conexão ociosa é fechada após este tempo
+#define HTTPD_MAX_REQUESTS 100      // requisições atendidas por conexão
+#define HTTPD_MAX_STREAMS 2         // conexões em modo fluxo
+#define HTTPD_STREAM_KEEPALIVE_S 10 // fluxo sem dados por este tempo recebe um comentário vazio (ou ping)
+#define HTTPD_MAX_WEBSOCKETS 2      // conexões WebSocket simultâneas
+#define HTTPD_WS_MAX_MESSAGE 512    // mensagem WebSocket recebida (fragmentos somados)
+#define HTTPD_SEND_MAX 1024         // trecho de fluxo ou quadro WebSocket enviado (cabeçalho incluído)
+// fluxos e WebSockets somados: ao menos uma posição sempre fica para requisições comuns
+#define HTTPD_MAX_LONG_LIVED (HTTPD_MAX_CONNS - 1)
+
+typedef enum {
+    HTTPD_GET,
+    HTTPD_HEAD,
+    HTTPD_POST,
+    HTTPD_OTHER,
+} httpd_method_t;
+
+// cabeçalhos da requisição cujo valor é guardado; os demais são descartados na leitura
+typedef enum {
+    HTTPD_H_CONNECTION,
+    HTTPD_H_CONTENT_LENGTH,
+    HTTPD_H_ACCEPT,
+    HTTPD_H_ACCEPT_ENCODING,
+    HTTPD_H_IF_NONE_MATCH,
+    HTTPD_H_UPGRADE,
+    HTTPD_H_SEC_WEBSOCKET_KEY,
+    HTTPD_H_SEC_WEBSOCKET_VERSION,
+    HTTPD_H_COUNT,
+} httpd_header_id_t;
+
+typedef struct {
+    const char *key;
+    const char *value;
+} httpd_param_t;
+
+typedef struct {
+    httpd_method_t method;
+    bool http10;                    // requisição HTTP/1.0
+    httpd_param_t params[HTTPD_MAX_PARAMS];
+    uint8_t num_params;
+    char query[HTTPD_QUERY_SIZE];   // armazenamento das chaves e valores, terminados por '\0'
+    char headers[HTTPD_H_COUNT][HTTPD_HEADER_VALUE_SIZE];
+    uint32_t present;               // bit (1 << httpd_header_id_t) para cada cabeçalho recebido
+} httpd_request_t;
+
+// mensagem completa recebida num WebSocket; id identifica a conexão em httpd_ws_send
+typedef void (*httpd_ws_handler_t)(int id, const uint8_t *data, size_t len, bool binary);
+
+// escreve o próximo trecho de um corpo gerado em dst (até cap bytes), retomando de *cursor
+// (0 na primeira chamada); retorna o tamanho escrito, 0 no fim do corpo
+typedef size_t (*httpd_fill_t)(char *dst, size_t cap, size_t *cursor);
+
+typedef struct {
+    int status;                     // código de status (200 por padrão)
+    char header[HTTPD_HEADER_SIZE]; // cabeçalhos adicionados com httpd_header
+    size_t header_len;
+    char body[HTTPD_BODY_SIZE];     // corpo dinâmico, escrito diretamente pelo handler
+    size_t body_len;
+    const void *static_body;        // ou um corpo constante (flash), enviado sem cópia
+    size_t static_len;
+    httpd_fill_t fill;              // ou um corpo gerado em trechos, sem tamanho conhecido
+    bool stream;                    // resposta sem fim: a conexão permanece aberta em modo fluxo
+    httpd_ws_handler_t websocket;   // upgrade aceito: a conexão passa a trocar quadros WebSocket
+} httpd_response_t;
+
+typedef void (*httpd_handler_t)(const httpd_request_t *req, httpd_response_t *resp);
+
+// contadores do servidor para o endpoint de métricas; o estado das conexões é estático,
+// então a "memória alocada" é a das posições ocupadas do conjunto fixo
+typedef struct {
+    uint32_t requests;              // requisições atendidas desde o início
+    uint32_t rejected;              // conexões recusadas com 503 (todas as posições ocupadas)
+    uint8_t connections;            // posições ocupadas
+    uint8_t streams;                // das quais em modo fluxo
+    uint8_t websockets;             // das quais WebSocket
+    uint32_t state_bytes;           // bytes de estado das posições ocupadas
+    uint32_t state_capacity;        // bytes reservados para as HTTPD_MAX_CONNS posições
+} httpd_stats_t;
+
+typedef struct {
+    httpd_method_t method;
+    const char *path;               // caminho exato, sem a query
+    httpd_handler_t handler;
+} httpd_route_t;
+
+// Abre o servidor na porta indicada. routes é a tabela de rotas (constante, até
+// HTTPD_MAX_ROUTES); fallback atende o que não casar com nenhuma rota. false se a porta
+// não pôde ser aberta
+bool httpd_init(uint16_t port, const httpd_route_t *routes, size_t num_routes, httpd_handler_t fallback);
+
+// Registra em recv_latency o tempo de cada callback de recepção do lwIP: análise,
+// handlers das rotas e início do envio (NULL desliga)
+void httpd_set_metrics(metrics_histogram_t *recv_latency);
+
+// Preenche os contadores e a ocupação atual das conexões
+void httpd_get_stats(httpd_stats_t *stats);
+
+// Define o código de status da resposta
+void httpd_status(httpd_response_t *resp, int status);
+
+// Acrescenta um cabeçalho à resposta ("Nome: valor", sem o CRLF final)
+void httpd_header(httpd_response_t *resp, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// Valor de um cabeçalho conhecido da requisição; NULL se não foi enviado
+static inline const char *httpd_request_header(const httpd_request_t *req, httpd_header_id_t id) {
+    return (req->present & (1u << id)) ? req->headers[id] : NULL;
+}
+
+// Valor decodificado de um parâmetro da query; NULL se ausente
+const char *httpd_param(const httpd_request_t *req, const char *key);
+
+// Verifica se uma lista separada por vírgulas (ex.: Accept-Encoding) contém o token,
+// sem diferenciar maiúsculas; parâmetros após ';' são ignorados. list pode ser NULL
+bool httpd_has_token(const char *list, const char *token);
+
+// Verifica se um If-None-Match (lista de entity-tags) casa com a ETag dada (sem aspas):
+// "*" casa com qualquer uma; o prefixo W/ é ignorado (comparação fraca). list pode ser NULL
+bool httpd_etag_match(const char *list, const char *etag);
+
+// Transforma a resposta num fluxo: sem Content-Length, o corpo (se houver) segue como
+// primeiro trecho e a conexão passa a receber httpd_stream_broadcast. false se já
+// houver HTTPD_MAX_STREAMS fluxos ou HTTPD_MAX_LONG_LIVED fluxos e WebSockets abertos
+bool httpd_stream(httpd_response_t *resp);
+
+// Envia os dados a todos os fluxos abertos (copiados para o lwIP); um cliente sem espaço
+// no buffer de envio perde este trecho. Retorna quantos clientes o receberam
+int httpd_stream_broadcast(const void *data, size_t len);
+
+// Aceita o upgrade para WebSocket pedido em req (101 Switching Protocols); as mensagens
+// recebidas são entregues a on_message. false, com a resposta já preenchida (400 ou
+// 503), se o pedido não for um handshake válido ou já houver HTTPD_MAX_WEBSOCKETS
+// WebSockets ou HTTPD_MAX_LONG_LIVED fluxos e WebSockets abertos
+bool httpd_websocket(const httpd_request_t *req, httpd_response_t *resp, httpd_ws_handler_t on_message);
+
+// Envia uma mensagem (binária ou texto) ao WebSocket id; false se ele não existir mais,
+// não houver espaço no buffer de envio ou o quadro passar de HTTPD_SEND_MAX
+bool httpd_ws_send(int id, const void *data, size_t len, bool binary);
+
+// Envia a mensagem a todos os WebSockets abertos; retorna quantos a receberam
+int httpd_ws_broadcast(const void *data, size_t len, bool binary);
+
+// Usa um corpo constante no lugar de resp->body; os dados devem existir até o fim da conexão
+static inline void httpd_static_body(httpd_response_t *resp, const void *data, size_t len) {
+    resp->static_body = data;
+    resp->static_len = len;
+}
+
+// Gera o corpo com fill, um trecho por vez em resp->body, cada um escrito depois que o
+// cliente confirmou o anterior: o corpo não precisa caber em HTTPD_BODY_SIZE. Segue com
+// Transfer-Encoding: chunked (em HTTP/1.0, delimitado pelo fechamento da conexão)
+static inline void httpd_generated_body(httpd_response_t *resp, httpd_fill_t fill) {
+    resp->fill = fill;
+}
+
+#endif // HTTPD_H
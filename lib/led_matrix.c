@@ -0,0 +1,95 @@
+#include <string.h>
+
+#include "led_matrix.h"
+
+const uint8_t led_matrix_pixel_map[LED_MATRIX_SIZE][LED_MATRIX_SIZE] = {
+    {24, 23, 22, 21, 20},
+    {15, 16, 17, 18, 19},
+    {14, 13, 12, 11, 10},
+    { 5,  6,  7,  8,  9},
+    { 4,  3,  2,  1,  0},
+};
+
+// round(255 * (i / 255)^2.2): intensidade percebida aproximadamente linear
+static const uint8_t gamma_table[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+void led_matrix_init(led_matrix_t *m, PIO pio, uint sm, uint8_t brightness) {
+    m->pio = pio;
+    m->sm = sm;
+    m->dma_channel = -1;
+    memset(m->pixels, 0, sizeof(m->pixels));
+    m->pending = false;
+    m->ready_at = get_absolute_time();
+    led_matrix_set_brightness(m, brightness);
+}
+
+void led_matrix_set_brightness(led_matrix_t *m, uint8_t brightness) {
+    for (int i = 0; i < 256; i++) {
+        m->levels[i] = (uint8_t)((gamma_table[i] * brightness + 127) / 255);
+    }
+    m->shown_valid = false;
+}
+
+void led_matrix_clear(led_matrix_t *m) {
+    memset(m->pixels, 0, sizeof(m->pixels));
+}
+
+void led_matrix_set(led_matrix_t *m, uint8_t row, uint8_t col, uint32_t rgb) {
+    if (row < LED_MATRIX_SIZE && col < LED_MATRIX_SIZE) m->pixels[row * LED_MATRIX_SIZE + col] = rgb;
+}
+
+void led_matrix_fill_row(led_matrix_t *m, uint8_t row, uint32_t rgb) {
+    for (uint8_t col = 0; col < LED_MATRIX_SIZE; col++) led_matrix_set(m, row, col, rgb);
+}
+
+void led_matrix_show(led_matrix_t *m) {
+    if (m->shown_valid && memcmp(m->pixels, m->shown, sizeof(m->pixels)) == 0) return;
+    memcpy(m->shown, m->pixels, sizeof(m->pixels));
+    m->shown_valid = true;
+    m->pending = true;
+    led_matrix_task(m);
+}
+
+void led_matrix_task(led_matrix_t *m) {
+    if (!m->pending) return;
+    // o DMA pode ter acabado, mas o PIO ainda transmite a FIFO e o latch precisa passar
+    if (!time_reached(m->ready_at)) return;
+    if (m->dma_channel >= 0 && dma_channel_is_busy(m->dma_channel)) return;
+    if (m->dma_channel < 0) m->dma_channel = dma_claim_unused_channel(true);
+
+    // cores lógicas -> níveis corrigidos -> palavra GRB alinhada à esquerda, na ordem física
+    for (uint8_t row = 0; row < LED_MATRIX_SIZE; row++) {
+        for (uint8_t col = 0; col < LED_MATRIX_SIZE; col++) {
+            uint32_t rgb = m->shown[row * LED_MATRIX_SIZE + col];
+            uint32_t r = m->levels[(rgb >> 16) & 0xFF], g = m->levels[(rgb >> 8) & 0xFF], b = m->levels[rgb & 0xFF];
+            m->words[led_matrix_pixel_map[row][col]] = ((g << 16) | (r << 8) | b) << 8u;
+        }
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(m->dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(m->pio, m->sm, true));
+    dma_channel_configure(m->dma_channel, &c, &m->pio->txf[m->sm], m->words, LED_MATRIX_PIXELS, true);
+
+    m->pending = false;
+    m->ready_at = make_timeout_time_us(LED_MATRIX_PIXELS * LED_MATRIX_PIXEL_US + LED_MATRIX_LATCH_US);
+}
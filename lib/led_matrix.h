@@ -0,0 +1,58 @@
+#ifndef LED_MATRIX_H
+#define LED_MATRIX_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+
+// Framebuffer da matriz 5x5 de WS2812 com envio por DMA para a FIFO de uma máquina do PIO
+// (programa ws2812.pio já carregado e iniciado). A aplicação desenha em coordenadas
+// lógicas (linha 0 no topo, coluna 0 à esquerda) e chama led_matrix_show(): se nada mudou
+// desde o último quadro enviado não há trabalho; senão as cores passam pela tabela de
+// gama/brilho, são reordenadas pelo pixel_map e o DMA alimenta o PIO sem a CPU.
+// O tempo de reset (latch) do WS2812 entre quadros é respeitado sem esperar: um quadro que
+// chega cedo fica pendente e sai em led_matrix_task().
+
+#define LED_MATRIX_SIZE 5
+#define LED_MATRIX_PIXELS (LED_MATRIX_SIZE * LED_MATRIX_SIZE)
+
+// tempo em nível baixo que fecha o quadro (WS2812B: > 280 us) e tempo de um pixel a 800 kHz
+#define LED_MATRIX_LATCH_US 300
+#define LED_MATRIX_PIXEL_US 30
+
+// índice físico (posição na cadeia de LEDs) de cada posição lógica: a fiação da BitDogLab
+// começa no canto inferior direito e faz zigue-zague entre as linhas
+extern const uint8_t led_matrix_pixel_map[LED_MATRIX_SIZE][LED_MATRIX_SIZE];
+
+typedef struct {
+    PIO pio;
+    uint sm;
+    int dma_channel;                        // -1 até o primeiro envio
+    uint32_t pixels[LED_MATRIX_PIXELS];     // cores lógicas 0xRRGGBB, linha a linha
+    uint32_t shown[LED_MATRIX_PIXELS];      // último quadro enviado (para o diff)
+    uint32_t words[LED_MATRIX_PIXELS];      // palavras GRB << 8 na ordem física, lidas pelo DMA
+    uint8_t levels[256];                    // gama 2,2 já multiplicada pelo brilho
+    bool shown_valid;                       // false força o envio do próximo quadro
+    bool pending;                           // quadro alterado aguardando o DMA ou o latch
+    absolute_time_t ready_at;               // fim do envio anterior mais o tempo de latch
+} led_matrix_t;
+
+// Associa a matriz à máquina de estados sm do pio; brightness de 0 a 255 (escala a saída da gama)
+void led_matrix_init(led_matrix_t *m, PIO pio, uint sm, uint8_t brightness);
+
+// Recalcula a tabela de níveis; o próximo quadro é enviado mesmo sem mudança de cor
+void led_matrix_set_brightness(led_matrix_t *m, uint8_t brightness);
+
+// Desenho no framebuffer (nada é enviado até led_matrix_show)
+void led_matrix_clear(led_matrix_t *m);
+void led_matrix_set(led_matrix_t *m, uint8_t row, uint8_t col, uint32_t rgb);
+void led_matrix_fill_row(led_matrix_t *m, uint8_t row, uint32_t rgb);
+
+// Publica o framebuffer: sem custo se igual ao último quadro enviado; senão dispara o DMA
+// ou, se o envio anterior/latch ainda não terminou, deixa o quadro pendente
+void led_matrix_show(led_matrix_t *m);
+
+// Envia o quadro pendente quando o DMA e o latch permitirem; chamada a cada passagem do loop
+void led_matrix_task(led_matrix_t *m);
+
+#endif // LED_MATRIX_H
@@ -0,0 +1,130 @@
+#include <string.h>
+
+#include "metrics.h"
+#include "fmt.h"
+
+void metrics_observe(metrics_histogram_t *h, uint32_t us) {
+    uint8_t i = 0;
+    while (i < h->num_bounds && us > h->bounds_us[i]) i++;
+
+    uint32_t seq = atomic_load_explicit(&h->seq, memory_order_relaxed);
+    atomic_store_explicit(&h->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    h->counts[i]++;
+    h->sum_us += us;
+    atomic_store_explicit(&h->seq, seq + 2, memory_order_release);
+}
+
+bool metrics_histogram_snapshot(const metrics_histogram_t *h, uint32_t counts[METRICS_MAX_BOUNDS + 1],
+                                uint64_t *sum_us) {
+    metrics_histogram_t *w = (metrics_histogram_t *)h; // só leitura; atomic_load pede ponteiro não-const
+    for (int attempt = 0; attempt < 16; attempt++) {
+        uint32_t seq = atomic_load_explicit(&w->seq, memory_order_acquire);
+        if (seq & 1) continue;
+        memcpy(counts, h->counts, sizeof(h->counts));
+        *sum_us = h->sum_us;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&w->seq, memory_order_relaxed) == seq) return true;
+    }
+    return false;
+}
+
+// microssegundos como segundos com 6 casas ("0.000250"), sem 64 bits no fmt
+static size_t metrics_write_seconds(char *dst, size_t cap, uint64_t us) {
+    size_t len = fmt_uint(dst, cap, (uint32_t)(us / 1000000u));
+    len += fmt_str(dst + len, cap - len, ".");
+    uint32_t frac = (uint32_t)(us % 1000000u);
+    for (uint32_t d = 100000; d > 0; d /= 10) {
+        char digit[2] = { (char)('0' + frac / d % 10), '\0' };
+        len += fmt_str(dst + len, cap - len, digit);
+    }
+    return len;
+}
+
+// "<name><suffix>{<labels>,<extra>}" (chaves omitidas se não houver rótulos)
+static size_t metrics_write_series(char *dst, size_t cap, const metrics_entry_t *e, const char *suffix,
+                                   const char *extra) {
+    size_t len = fmt_str(dst, cap, e->name);
+    len += fmt_str(dst + len, cap - len, suffix);
+    if (e->labels || extra) {
+        len += fmt_str(dst + len, cap - len, "{");
+        if (e->labels) len += fmt_str(dst + len, cap - len, e->labels);
+        if (e->labels && extra) len += fmt_str(dst + len, cap - len, ",");
+        if (extra) len += fmt_str(dst + len, cap - len, extra);
+        len += fmt_str(dst + len, cap - len, "}");
+    }
+    return len + fmt_str(dst + len, cap - len, " ");
+}
+
+static size_t metrics_write_histogram(char *dst, size_t cap, const metrics_entry_t *e) {
+    const metrics_histogram_t *h = e->metric;
+    uint32_t counts[METRICS_MAX_BOUNDS + 1];
+    uint64_t sum_us;
+    if (!metrics_histogram_snapshot(h, counts, &sum_us)) return 0; // série omitida nesta coleta
+
+    size_t len = 0;
+    uint32_t cumulative = 0;
+    char le[24];
+    for (uint8_t i = 0; i <= h->num_bounds; i++) {
+        cumulative += counts[i];
+        size_t n = fmt_str(le, sizeof(le), "le=\"");
+        if (i < h->num_bounds) {
+            n += metrics_write_seconds(le + n, sizeof(le) - n, h->bounds_us[i]);
+        } else {
+            n += fmt_str(le + n, sizeof(le) - n, "+Inf");
+        }
+        fmt_str(le + n, sizeof(le) - n, "\"");
+        len += metrics_write_series(dst + len, cap - len, e, "_bucket", le);
+        len += fmt_uint(dst + len, cap - len, cumulative);
+        len += fmt_str(dst + len, cap - len, "\n");
+    }
+    len += metrics_write_series(dst + len, cap - len, e, "_sum", NULL);
+    len += metrics_write_seconds(dst + len, cap - len, sum_us);
+    len += fmt_str(dst + len, cap - len, "\n");
+    len += metrics_write_series(dst + len, cap - len, e, "_count", NULL);
+    len += fmt_uint(dst + len, cap - len, cumulative);
+    return len + fmt_str(dst + len, cap - len, "\n");
+}
+
+// uma série, precedida das linhas HELP e TYPE se abrir uma família
+static size_t metrics_write_entry(char *dst, size_t cap, const metrics_entry_t *entries, size_t i) {
+    static const char *const type_names[] = { "counter", "gauge", "histogram" };
+    const metrics_entry_t *e = &entries[i];
+    size_t len = 0;
+    if (i == 0 || strcmp(e->name, entries[i - 1].name) != 0) {
+        len += fmt_str(dst + len, cap - len, "# HELP ");
+        len += fmt_str(dst + len, cap - len, e->name);
+        len += fmt_str(dst + len, cap - len, " ");
+        len += fmt_str(dst + len, cap - len, e->help);
+        len += fmt_str(dst + len, cap - len, "\n# TYPE ");
+        len += fmt_str(dst + len, cap - len, e->name);
+        len += fmt_str(dst + len, cap - len, " ");
+        len += fmt_str(dst + len, cap - len, type_names[e->type]);
+        len += fmt_str(dst + len, cap - len, "\n");
+    }
+    if (e->type == METRICS_HISTOGRAM) return len + metrics_write_histogram(dst + len, cap - len, e);
+
+    len += metrics_write_series(dst + len, cap - len, e, "", NULL);
+    if (e->type == METRICS_COUNTER) {
+        metrics_counter_t *c = (metrics_counter_t *)e->metric;
+        len += fmt_uint(dst + len, cap - len, atomic_load_explicit(&c->value, memory_order_relaxed));
+    } else {
+        metrics_gauge_t *g = (metrics_gauge_t *)e->metric;
+        len += fmt_int(dst + len, cap - len, atomic_load_explicit(&g->value, memory_order_relaxed));
+    }
+    return len + fmt_str(dst + len, cap - len, "\n");
+}
+
+size_t metrics_format(char *dst, size_t cap, const metrics_entry_t *entries, size_t count, size_t *next) {
+    size_t len = 0;
+    for (; *next < count; (*next)++) {
+        size_t n = metrics_write_entry(dst + len, cap - len, entries, *next);
+        // fmt escreve no máximo cap - 1: chegar a esse ponto significa que a série foi cortada
+        if (len + n + 1 >= cap) {
+            if (len > 0) break;                 // segue no próximo trecho
+            continue;                           // não cabe nem sozinha: omitida
+        }
+        len += n;
+    }
+    return len;
+}
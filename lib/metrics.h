@@ -0,0 +1,96 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pico/time.h"
+
+// Instrumentação barata para o endpoint /metrics: contadores, medidores (gauges) e
+// histogramas de latência com baldes fixos, em microssegundos medidos com time_us_64().
+// Registrar uma observação custa uma busca linear nos limites e alguns stores, sem travas
+// e sem alocação. Cada métrica tem um único escritor (um núcleo, fora de interrupções) e
+// pode ser lida pelo outro núcleo: contadores e medidores são palavras de 32 bits lidas
+// atomicamente e cada histograma tem um contador de sequência (par: estável) com o qual
+// o leitor tira uma cópia consistente, repetindo se cruzar com uma escrita.
+// metrics_format() escreve uma tabela de métricas no formato de texto do Prometheus,
+// em trechos que retomam de onde o anterior parou, para a exposição não precisar caber
+// num único buffer; os histogramas saem em segundos, como pede a convenção.
+
+#define METRICS_MAX_BOUNDS 8    // limites por histograma (mais o balde +Inf)
+
+typedef struct {
+    atomic_uint value;
+} metrics_counter_t;
+
+typedef struct {
+    atomic_int value;
+} metrics_gauge_t;
+
+typedef struct {
+    const uint32_t *bounds_us;  // limites superiores dos baldes, crescentes
+    uint8_t num_bounds;         // até METRICS_MAX_BOUNDS
+    atomic_uint seq;            // ímpar durante uma escrita
+    uint32_t counts[METRICS_MAX_BOUNDS + 1]; // por balde (não acumulado); o último é +Inf
+    uint64_t sum_us;
+} metrics_histogram_t;
+
+// histograma com os limites de um vetor constante
+#define METRICS_HISTOGRAM(bounds) { .bounds_us = (bounds), .num_bounds = (uint8_t)(sizeof(bounds) / sizeof((bounds)[0])) }
+
+static inline void metrics_counter_add(metrics_counter_t *c, uint32_t n) {
+    // escritor único: load + store bastam (o Cortex-M0+ não tem LDREX/STREX)
+    atomic_store_explicit(&c->value, atomic_load_explicit(&c->value, memory_order_relaxed) + n,
+                          memory_order_relaxed);
+}
+
+// espelha um contador mantido por outro módulo (ex.: descartes de spsc_ring)
+static inline void metrics_counter_set(metrics_counter_t *c, uint32_t value) {
+    atomic_store_explicit(&c->value, value, memory_order_relaxed);
+}
+
+static inline void metrics_gauge_set(metrics_gauge_t *g, int32_t value) {
+    atomic_store_explicit(&g->value, value, memory_order_relaxed);
+}
+
+void metrics_observe(metrics_histogram_t *h, uint32_t us);
+
+// uso: uint64_t t0 = metrics_start(); ...; metrics_stop(&hist, t0);
+static inline uint64_t metrics_start(void) {
+    return time_us_64();
+}
+
+static inline void metrics_stop(metrics_histogram_t *h, uint64_t start_us) {
+    uint64_t elapsed = time_us_64() - start_us;
+    metrics_observe(h, elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed);
+}
+
+// Cópia consistente dos baldes e da soma; false se o escritor não parou de escrever
+bool metrics_histogram_snapshot(const metrics_histogram_t *h, uint32_t counts[METRICS_MAX_BOUNDS + 1],
+                                uint64_t *sum_us);
+
+typedef enum {
+    METRICS_COUNTER,
+    METRICS_GAUGE,
+    METRICS_HISTOGRAM,
+} metrics_type_t;
+
+// uma série da tabela; séries consecutivas com o mesmo nome formam uma família e
+// compartilham as linhas HELP e TYPE
+typedef struct {
+    const char *name;           // ex.: "estacao_http_requests_total"
+    const char *help;
+    metrics_type_t type;
+    const char *labels;         // ex.: "sensor=\"bmp280\"" ou NULL
+    const void *metric;         // metrics_counter_t, metrics_gauge_t ou metrics_histogram_t
+} metrics_entry_t;
+
+// Escreve as séries no formato de texto do Prometheus (version 0.0.4) a partir de
+// entries[*next], só séries inteiras, até encher dst; *next avança até a primeira série
+// que ficou de fora. Retorna o tamanho escrito, 0 quando não resta nenhuma série. Uma
+// série que sozinha não cabe em cap é omitida
+size_t metrics_format(char *dst, size_t cap, const metrics_entry_t *entries, size_t count, size_t *next);
+
+#endif // METRICS_H
@@ -0,0 +1,84 @@
+#include "rollup.h"
+
+void rollup_tier_init(rollup_tier_t *tier, uint32_t resolution_s, rollup_bucket_t *storage, uint32_t capacity) {
+    tier->resolution_s = resolution_s;
+    tier->buckets = storage;
+    tier->capacity = capacity;
+    tier->head = 0;
+    tier->count = 0;
+    tier->open.count = 0;
+}
+
+void rollup_init(rollup_t *r, rollup_tier_t *tiers, uint32_t num_tiers) {
+    r->tiers = tiers;
+    r->num_tiers = num_tiers;
+}
+
+static void rollup_tier_add(rollup_tier_t *tier, uint32_t timestamp_s, const int32_t values[ROLLUP_CHANNELS]) {
+    uint32_t start = timestamp_s - timestamp_s % tier->resolution_s;
+    rollup_bucket_t *b = &tier->open;
+
+    if (b->count > 0 && b->start_s != start) {
+        // a amostra pertence a um novo balde: fecha o atual na fila circular
+        tier->buckets[tier->head] = *b;
+        tier->head = (tier->head + 1) % tier->capacity;
+        if (tier->count < tier->capacity) {
+            tier->count++;
+        }
+        b->count = 0;
+    }
+    if (b->count == 0) {
+        b->start_s = start;
+        for (uint32_t c = 0; c < ROLLUP_CHANNELS; c++) {
+            b->min[c] = b->max[c] = values[c];
+            b->sum[c] = 0;
+        }
+    }
+    for (uint32_t c = 0; c < ROLLUP_CHANNELS; c++) {
+        if (values[c] < b->min[c]) b->min[c] = values[c];
+        if (values[c] > b->max[c]) b->max[c] = values[c];
+        b->sum[c] += values[c];
+    }
+    b->count++;
+}
+
+void rollup_add(rollup_t *r, uint32_t timestamp_s, const int32_t values[ROLLUP_CHANNELS]) {
+    for (uint32_t i = 0; i < r->num_tiers; i++) {
+        rollup_tier_add(&r->tiers[i], timestamp_s, values);
+    }
+}
+
+const rollup_tier_t *rollup_select(const rollup_t *r, uint32_t window_s, uint32_t max_points) {
+    for (uint32_t i = 0; i < r->num_tiers; i++) {
+        const rollup_tier_t *tier = &r->tiers[i];
+        bool cabe = (window_s + tier->resolution_s - 1) / tier->resolution_s <= max_points;
+        bool cobre = tier->resolution_s * tier->capacity >= window_s;
+        if (cabe && cobre) {
+            return tier;
+        }
+    }
+    return &r->tiers[r->num_tiers - 1];
+}
+
+uint32_t rollup_tier_size(const rollup_tier_t *tier) {
+    return tier->count + (tier->open.count > 0 ? 1 : 0);
+}
+
+bool rollup_tier_get(const rollup_tier_t *tier, uint32_t index, rollup_bucket_t *out) {
+    if (index < tier->count) {
+        uint32_t oldest = (tier->head + tier->capacity - tier->count) % tier->capacity;
+        *out = tier->buckets[(oldest + index) % tier->capacity];
+        return true;
+    }
+    if (index == tier->count && tier->open.count > 0) {
+        *out = tier->open;
+        return true;
+    }
+    return false;
+}
+
+int32_t rollup_bucket_avg(const rollup_bucket_t *bucket, uint32_t channel) {
+    int32_t n = (int32_t)bucket->count;
+    int32_t sum = bucket->sum[channel];
+    return sum >= 0 ? (sum + n / 2) / n : (sum - n / 2) / n;
+}
@@ -0,0 +1,57 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Agregação incremental das medições em várias resoluções (camadas).
+// Cada camada é uma fila circular de baldes de duração fixa com mínimo, máximo, soma
+// e contagem por canal; cada amostra atualiza o balde aberto de todas as camadas em
+// O(1). Consultas de janelas longas leem poucos baldes em vez de todas as amostras.
+
+#define ROLLUP_CHANNELS 4
+
+typedef struct {
+    uint32_t start_s;                  // início do balde, em segundos desde o boot
+    uint32_t count;                    // amostras agregadas
+    int32_t min[ROLLUP_CHANNELS];
+    int32_t max[ROLLUP_CHANNELS];
+    int32_t sum[ROLLUP_CHANNELS];
+} rollup_bucket_t;
+
+typedef struct {
+    uint32_t resolution_s;             // duração de cada balde
+    rollup_bucket_t *buckets;          // baldes fechados (fila circular)
+    uint32_t capacity;
+    uint32_t head;                     // posição do próximo balde fechado
+    uint32_t count;                    // baldes fechados válidos
+    rollup_bucket_t open;              // balde em andamento (count == 0 se vazio)
+} rollup_tier_t;
+
+typedef struct {
+    rollup_tier_t *tiers;              // da resolução mais fina para a mais grossa
+    uint32_t num_tiers;
+} rollup_t;
+
+// Inicializa uma camada sobre um vetor de capacity baldes
+void rollup_tier_init(rollup_tier_t *tier, uint32_t resolution_s, rollup_bucket_t *storage, uint32_t capacity);
+
+void rollup_init(rollup_t *r, rollup_tier_t *tiers, uint32_t num_tiers);
+
+// Agrega uma amostra (valores inteiros já escalados) em todas as camadas
+void rollup_add(rollup_t *r, uint32_t timestamp_s, const int32_t values[ROLLUP_CHANNELS]);
+
+// Escolhe a camada mais fina que cobre window_s com no máximo max_points baldes;
+// se nenhuma satisfaz, devolve a mais grossa
+const rollup_tier_t *rollup_select(const rollup_t *r, uint32_t window_s, uint32_t max_points);
+
+// Quantidade de baldes disponíveis na camada, incluindo o balde em andamento
+uint32_t rollup_tier_size(const rollup_tier_t *tier);
+
+// Copia o i-ésimo balde em ordem cronológica (0 é o mais antigo); o último é o em andamento
+bool rollup_tier_get(const rollup_tier_t *tier, uint32_t index, rollup_bucket_t *out);
+
+// Média arredondada de um canal do balde
+int32_t rollup_bucket_avg(const rollup_bucket_t *bucket, uint32_t channel);
+
+#endif // ROLLUP_H
@@ -0,0 +1,124 @@
+#include "sensors.h"
+
+void sensors_init(sensors_t *s, i2c_inst_t *i2c, uint32_t period_ms, const bmp280_config_t *bmp_config,
+                  const sensors_filter_config_t *filter_config) {
+    static const bmp280_config_t bmp_default = BMP280_CONFIG_DEFAULT;
+    static const sensors_filter_config_t filter_default = SENSORS_FILTER_DEFAULT;
+
+    s->i2c = i2c;
+    s->period_ms = period_ms;
+    s->bmp_state = SENSORS_IDLE;
+    s->aht_state = SENSORS_IDLE;
+    s->sample = (sensors_sample_t){0};
+    s->bmp_read_latency = NULL;
+    s->aht_read_latency = NULL;
+
+    s->bmp_config = bmp_config ? *bmp_config : bmp_default;
+    s->filter_config = filter_config ? *filter_config : filter_default;
+    filter_init(&s->temp_filter, &s->filter_config.filter);
+    filter_init(&s->press_filter, &s->filter_config.filter);
+    filter_init(&s->umid_filter, &s->filter_config.filter);
+
+    bmp280_configure(i2c, &s->bmp_config);
+    bmp280_get_calib_params(i2c, &s->bmp_params);
+    aht20_init(i2c);
+
+    s->bmp_next_start = get_absolute_time();
+    s->aht_next_start = s->bmp_next_start;
+    s->next_output = make_timeout_time_ms(period_ms);
+}
+
+void sensors_set_metrics(sensors_t *s, metrics_histogram_t *bmp_read, metrics_histogram_t *aht_read) {
+    s->bmp_read_latency = bmp_read;
+    s->aht_read_latency = aht_read;
+}
+
+// avança um instante periódico; depois de um atraso grande, reancora a partir de agora
+static absolute_time_t sensors_next_period(absolute_time_t next, absolute_time_t now, uint32_t period_ms) {
+    next = delayed_by_ms(next, period_ms);
+    return absolute_time_diff_us(now, next) <= 0 ? delayed_by_ms(now, period_ms) : next;
+}
+
+static void sensors_bmp_task(sensors_t *s, absolute_time_t now) {
+    switch (s->bmp_state) {
+        case SENSORS_IDLE:
+            if (absolute_time_diff_us(now, s->bmp_next_start) > 0) return;
+            s->bmp_next_start = sensors_next_period(s->bmp_next_start, now, s->filter_config.bmp_interval_ms);
+            if (!bmp280_start_measurement(s->i2c, &s->bmp_config)) return;
+            s->bmp_poll_after = make_timeout_time_ms(bmp280_measurement_time_ms(&s->bmp_config));
+            s->bmp_deadline = make_timeout_time_ms(SENSORS_TIMEOUT_MS);
+            s->bmp_state = SENSORS_CONVERTING;
+            return;
+
+        case SENSORS_CONVERTING:
+            if (absolute_time_diff_us(now, s->bmp_poll_after) > 0) return;
+            // no modo normal os registradores têm sempre uma conversão completa: não há o que esperar
+            if (s->bmp_config.mode == BMP280_MODE_NORMAL || bmp280_measurement_ready(s->i2c)) {
+                bmp280_reading_t reading;
+                uint64_t start = metrics_start();
+                bool ok = bmp280_read(s->i2c, &s->bmp_params, &s->bmp_config, &reading);
+                if (s->bmp_read_latency) metrics_stop(s->bmp_read_latency, start);
+                if (ok) {
+                    // a compensação do BMP280 já entrega centésimos de °C e Pa inteiros
+                    filter_add(&s->temp_filter, reading.temperature_c100);
+                    filter_add(&s->press_filter, (int32_t)reading.pressure_pa);
+                }
+            } else if (absolute_time_diff_us(now, s->bmp_deadline) > 0) {
+                return;
+            }
+            s->bmp_state = SENSORS_IDLE;
+            return;
+    }
+}
+
+static void sensors_aht_task(sensors_t *s, absolute_time_t now) {
+    switch (s->aht_state) {
+        case SENSORS_IDLE:
+            if (absolute_time_diff_us(now, s->aht_next_start) > 0) return;
+            if (s->filter_config.aht_interval_ms) {
+                s->aht_next_start = sensors_next_period(s->aht_next_start, now, s->filter_config.aht_interval_ms);
+            }
+            if (!aht20_start_measurement(s->i2c)) {
+                s->aht_next_start = make_timeout_time_ms(AHT20_CONVERSION_MS); // sem resposta: tenta depois
+                return;
+            }
+            s->aht_poll_after = make_timeout_time_ms(AHT20_CONVERSION_MS);
+            s->aht_deadline = make_timeout_time_ms(SENSORS_TIMEOUT_MS);
+            s->aht_state = SENSORS_CONVERTING;
+            return;
+
+        case SENSORS_CONVERTING:
+            if (absolute_time_diff_us(now, s->aht_poll_after) > 0) return;
+            if (aht20_measurement_ready(s->i2c)) {
+                AHT20_Data data;
+                uint64_t start = metrics_start();
+                bool ok = aht20_fetch(s->i2c, &data);
+                if (s->aht_read_latency) metrics_stop(s->aht_read_latency, start);
+                if (ok) filter_add(&s->umid_filter, data.humidity_c100);
+            } else if (absolute_time_diff_us(now, s->aht_deadline) > 0) {
+                return;
+            }
+            s->aht_state = SENSORS_IDLE;
+            return;
+    }
+}
+
+bool sensors_task(sensors_t *s) {
+    absolute_time_t now = get_absolute_time();
+    sensors_bmp_task(s, now);
+    sensors_aht_task(s, now);
+
+    if (absolute_time_diff_us(now, s->next_output) > 0) {
+        return false;
+    }
+    s->next_output = sensors_next_period(s->next_output, now, s->period_ms);
+
+    s->sample.timestamp_us = to_us_since_boot(now);
+    s->sample.bmp_readings = (uint16_t)s->press_filter.count;
+    s->sample.aht_readings = (uint16_t)s->umid_filter.count;
+    bool temp_ok = filter_output(&s->temp_filter, &s->sample.temp_c100);
+    bool press_ok = filter_output(&s->press_filter, &s->sample.press_pa);
+    s->sample.bmp_ok = temp_ok && press_ok;
+    s->sample.aht_ok = filter_output(&s->umid_filter, &s->sample.umid_c100);
+    return true;
+}
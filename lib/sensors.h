@@ -0,0 +1,88 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "aht20.h"
+#include "bmp280.h"
+#include "filter.h"
+#include "metrics.h"
+
+// Aquisição do AHT20 e do BMP280 acima da taxa de publicação, com estágio de filtragem.
+// sensors_task() é chamada a cada passagem do loop principal e nunca dorme: duas máquinas
+// de estados independentes disparam as conversões de cada sensor na própria taxa de
+// entrada, consultam o bit de ocupado depois do tempo de conversão esperado e passam cada
+// leitura bruta pelo filtro do canal (lib/filter.h). A cada período de saída a amostra
+// filtrada é publicada.
+
+// tempo máximo de espera por uma conversão antes de descartá-la
+#define SENSORS_TIMEOUT_MS 150
+
+typedef enum {
+    SENSORS_IDLE,       // aguardando o próximo disparo
+    SENSORS_CONVERTING, // conversão disparada, aguardando o sensor
+} sensors_state_t;
+
+// taxas de entrada e filtro aplicado a temperatura, pressão e umidade
+typedef struct {
+    uint32_t bmp_interval_ms;   // período das conversões do BMP280 (no modo normal, >= standby)
+    uint32_t aht_interval_ms;   // período das conversões do AHT20; 0: uma atrás da outra (~12 Hz)
+    filter_config_t filter;
+} sensors_filter_config_t;
+
+// BMP280 a 25 Hz, AHT20 na taxa máxima, mediana de 5 e média por período
+#define SENSORS_FILTER_DEFAULT { 40, 0, FILTER_CONFIG_DEFAULT }
+
+// amostra publicada a cada período
+typedef struct {
+    uint64_t timestamp_us;  // instante da publicação (fim do período filtrado)
+    int32_t temp_c100;      // centésimos de °C (BMP280)
+    int32_t press_pa;       // Pa (BMP280)
+    int32_t umid_c100;      // centésimos de % (AHT20)
+    uint16_t bmp_readings;  // leituras brutas combinadas na amostra
+    uint16_t aht_readings;
+    bool bmp_ok;            // false se o BMP280 não respondeu no período; campos mantêm o valor anterior
+    bool aht_ok;            // false se o AHT20 não respondeu no período; humidity mantém o valor anterior
+} sensors_sample_t;
+
+typedef struct {
+    i2c_inst_t *i2c;
+    struct bmp280_calib_param bmp_params;
+    bmp280_config_t bmp_config;
+    sensors_filter_config_t filter_config;
+    uint32_t period_ms;
+    absolute_time_t next_output;  // fim do período de saída em andamento
+
+    sensors_state_t bmp_state;
+    absolute_time_t bmp_next_start; // próximo disparo do BMP280
+    absolute_time_t bmp_poll_after; // primeira consulta ao status depois do disparo
+    absolute_time_t bmp_deadline;   // limite para a conversão em andamento
+
+    sensors_state_t aht_state;
+    absolute_time_t aht_next_start;
+    absolute_time_t aht_poll_after;
+    absolute_time_t aht_deadline;
+
+    filter_t temp_filter;
+    filter_t press_filter;
+    filter_t umid_filter;
+    sensors_sample_t sample;      // última amostra publicada
+
+    metrics_histogram_t *bmp_read_latency; // tempo de cada leitura I2C (NULL: sem medição)
+    metrics_histogram_t *aht_read_latency;
+} sensors_t;
+
+// Inicializa os dois sensores (bloqueante, apenas no boot) e agenda as primeiras conversões.
+// bmp_config escolhe sobreamostragem, filtro e modo do BMP280 (NULL usa BMP280_CONFIG_DEFAULT);
+// filter_config, as taxas de entrada e o filtro (NULL usa SENSORS_FILTER_DEFAULT)
+void sensors_init(sensors_t *s, i2c_inst_t *i2c, uint32_t period_ms, const bmp280_config_t *bmp_config,
+                  const sensors_filter_config_t *filter_config);
+
+// Passa a registrar nos histogramas o tempo de cada leitura de resultado do BMP280 e do
+// AHT20 (transação I2C e compensação); NULL desliga. Chamar no núcleo da aquisição
+void sensors_set_metrics(sensors_t *s, metrics_histogram_t *bmp_read, metrics_histogram_t *aht_read);
+
+// Avança a aquisição; retorna true quando s->sample contém uma nova amostra
+bool sensors_task(sensors_t *s);
+
+#endif // SENSORS_H
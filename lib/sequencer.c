@@ -0,0 +1,111 @@
+#include "sequencer.h"
+#include "hardware/clocks.h"
+
+// alarmes simultâneos no pool: só o do padrão em execução
+#define SEQ_POOL_TIMERS 2
+
+static void sequencer_apply(sequencer_t *s, const seq_step_t *step) {
+    gpio_put(s->pin_r, step->rgb & SEQ_R);
+    gpio_put(s->pin_g, step->rgb & SEQ_G);
+    gpio_put(s->pin_b, step->rgb & SEQ_B);
+
+    if (!step->tone_hz) {
+        pwm_set_gpio_level(s->buzzer_pin, 0);
+        return;
+    }
+    uint32_t wrap = SEQ_PWM_COUNT_HZ / step->tone_hz - 1;
+    if (wrap > 0xFFFF) wrap = 0xFFFF;
+    if (step->tone_hz != s->tone_hz) {
+        pwm_set_wrap(s->slice, (uint16_t)wrap);
+        s->tone_hz = step->tone_hz;
+    }
+    pwm_set_gpio_level(s->buzzer_pin, (uint16_t)((wrap + 1) / 2)); // 50% de ciclo
+}
+
+static int64_t step_us(const seq_step_t *step) {
+    return step->duration_ms ? (int64_t)step->duration_ms * 1000 : 1000;
+}
+
+// IRQ do alarme: aplica o próximo passo e reagenda relativo ao disparo anterior (retorno < 0)
+static int64_t sequencer_alarm(alarm_id_t id, void *user_data) {
+    (void)id;
+    sequencer_t *s = user_data;
+    const seq_pattern_t *p = s->pattern;
+    if (!p) return 0;
+
+    if (++s->step >= p->count) {
+        s->step = 0;
+        if (p->repeats && ++s->cycle >= p->repeats) {
+            pwm_set_gpio_level(s->buzzer_pin, 0);
+            s->alarm_id = 0;
+            return 0;
+        }
+    }
+    const seq_step_t *step = &p->steps[s->step];
+    sequencer_apply(s, step);
+    return -step_us(step);
+}
+
+void sequencer_init(sequencer_t *s, uint pin_r, uint pin_g, uint pin_b, uint buzzer_pin) {
+    s->pin_r = pin_r;
+    s->pin_g = pin_g;
+    s->pin_b = pin_b;
+    s->buzzer_pin = buzzer_pin;
+    s->tone_hz = 0;
+    s->alarm_id = 0;
+    s->pattern = NULL;
+    s->step = 0;
+    s->cycle = 0;
+
+    uint pins[] = {pin_r, pin_g, pin_b};
+    for (int i = 0; i < 3; i++) {
+        gpio_init(pins[i]);
+        gpio_set_dir(pins[i], GPIO_OUT);
+        gpio_put(pins[i], 0);
+    }
+
+    gpio_set_function(buzzer_pin, GPIO_FUNC_PWM);
+    s->slice = pwm_gpio_to_slice_num(buzzer_pin);
+    pwm_set_clkdiv(s->slice, (float)clock_get_hz(clk_sys) / SEQ_PWM_COUNT_HZ);
+    pwm_set_wrap(s->slice, 0xFFFF); // tone_hz = 0: o primeiro tom reprograma o wrap
+    pwm_set_gpio_level(buzzer_pin, 0);
+    pwm_set_enabled(s->slice, true);
+
+    s->pool = alarm_pool_create_with_unused_hardware_alarm(SEQ_POOL_TIMERS);
+}
+
+static void sequencer_cancel(sequencer_t *s) {
+    if (s->alarm_id) {
+        alarm_pool_cancel_alarm(s->pool, s->alarm_id);
+        s->alarm_id = 0;
+    }
+    s->pattern = NULL;
+}
+
+void sequencer_play(sequencer_t *s, const seq_pattern_t *pattern) {
+    if (pattern == s->pattern) return;
+    if (!pattern || !pattern->count) {
+        sequencer_stop(s);
+        return;
+    }
+    sequencer_cancel(s); // as saídas ficam como estão até o primeiro passo do novo padrão
+
+    s->pattern = pattern;
+    s->step = 0;
+    s->cycle = 0;
+    sequencer_apply(s, &pattern->steps[0]);
+    // passo único e silencioso tocado uma vez: a saída já é a final, nada a agendar
+    if (pattern->count == 1 && pattern->repeats == 1 && !pattern->steps[0].tone_hz) return;
+
+    alarm_id_t id = alarm_pool_add_alarm_in_us(s->pool, (uint64_t)step_us(&pattern->steps[0]),
+                                               sequencer_alarm, s, true);
+    s->alarm_id = id > 0 ? id : 0;
+}
+
+void sequencer_stop(sequencer_t *s) {
+    sequencer_cancel(s);
+    pwm_set_gpio_level(s->buzzer_pin, 0);
+    gpio_put(s->pin_r, 0);
+    gpio_put(s->pin_g, 0);
+    gpio_put(s->pin_b, 0);
+}
@@ -0,0 +1,59 @@
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+
+// Sequenciador de padrões do LED RGB e do buzzer. Um padrão é uma lista de passos (tom,
+// duração, cor) tocada por um alarme repetitivo do timer: cada disparo aplica o passo
+// seguinte e reagenda o alarme relativo ao disparo anterior, sem acumular atraso e sem
+// passar pelo loop principal. A aplicação só escolhe o padrão com sequencer_play().
+// Os alarmes vêm de um pool próprio, criado no núcleo que chama sequencer_init(): a IRQ
+// roda nesse núcleo e não concorre com a pilha de rede do outro.
+
+// bits de cor de um passo
+#define SEQ_R 0x1
+#define SEQ_G 0x2
+#define SEQ_B 0x4
+
+// base de tempo do PWM do buzzer: o contador anda a 1 MHz, então wrap = 1e6 / tom - 1
+#define SEQ_PWM_COUNT_HZ 1000000u
+
+typedef struct {
+    uint16_t tone_hz;       // frequência do buzzer (0: silêncio; mínimo de 16 Hz)
+    uint16_t duration_ms;   // tempo até o próximo passo
+    uint8_t rgb;            // SEQ_R | SEQ_G | SEQ_B acesos durante o passo
+} seq_step_t;
+
+typedef struct {
+    const seq_step_t *steps;
+    uint8_t count;
+    uint8_t repeats;        // 0: repete até outro padrão; n: toca n vezes, depois o buzzer
+                            // silencia e o LED fica na cor do último passo
+} seq_pattern_t;
+
+// monta um seq_pattern_t a partir de um vetor de passos
+#define SEQ_PATTERN(steps, repeats) { (steps), (uint8_t)(sizeof(steps) / sizeof((steps)[0])), (repeats) }
+
+typedef struct {
+    uint pin_r, pin_g, pin_b;
+    uint buzzer_pin;
+    uint slice;
+    uint16_t tone_hz;                       // tom para o qual o wrap está programado
+    alarm_pool_t *pool;
+    volatile alarm_id_t alarm_id;           // 0: nenhum alarme agendado
+    const seq_pattern_t *volatile pattern;  // padrão em execução (NULL: nenhum)
+    uint8_t step;
+    uint8_t cycle;
+} sequencer_t;
+
+// Configura os pinos do LED RGB como saída, a fatia PWM do buzzer a 1 MHz e o pool de alarmes
+void sequencer_init(sequencer_t *s, uint pin_r, uint pin_g, uint pin_b, uint buzzer_pin);
+
+// Troca o padrão em execução; o mesmo padrão de novo não reinicia a sequência
+void sequencer_play(sequencer_t *s, const seq_pattern_t *pattern);
+
+// Para o padrão, silencia o buzzer e apaga o LED
+void sequencer_stop(sequencer_t *s);
+
+#endif // SEQUENCER_H
@@ -0,0 +1,26 @@
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// SHA-1 (FIPS 180-4) compacto, usado apenas para a chave de aceite do handshake
+// WebSocket (RFC 6455); não serve para fins de segurança.
+
+#define SHA1_DIGEST_SIZE 20
+
+typedef struct {
+    uint32_t state[5];
+    uint64_t length;        // bytes processados
+    uint8_t block[64];
+    uint32_t fill;          // bytes pendentes em block
+} sha1_t;
+
+void sha1_init(sha1_t *ctx);
+
+void sha1_update(sha1_t *ctx, const void *data, size_t len);
+
+// completa o hash e escreve os 20 bytes do resultado em digest
+void sha1_final(sha1_t *ctx, uint8_t digest[SHA1_DIGEST_SIZE]);
+
+#endif // SHA1_H
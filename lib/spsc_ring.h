@@ -0,0 +1,34 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fila circular sem travas para um único produtor e um único consumidor, usada para
+// passar dados entre os dois núcleos do RP2040. Os índices são contadores livres de 32
+// bits: só o produtor escreve head e só o consumidor escreve tail, com ordenação
+// release/acquire (apenas loads/stores, suportados pelo Cortex-M0+ sem LDREX/STREX).
+
+typedef struct {
+    uint8_t *buffer;
+    uint32_t elem_size;
+    uint32_t capacity;      // número de elementos, potência de 2
+    atomic_uint head;       // próxima posição de escrita (produtor)
+    atomic_uint tail;       // próxima posição de leitura (consumidor)
+    atomic_uint dropped;    // elementos descartados com a fila cheia
+} spsc_ring_t;
+
+// storage deve ter capacity * elem_size bytes; capacity precisa ser potência de 2
+void spsc_ring_init(spsc_ring_t *ring, void *storage, uint32_t elem_size, uint32_t capacity);
+
+// copia o elemento para a fila; false (e conta um descarte) se estiver cheia
+bool spsc_ring_push(spsc_ring_t *ring, const void *elem);
+
+// retira o elemento mais antigo; false se a fila estiver vazia
+bool spsc_ring_pop(spsc_ring_t *ring, void *elem);
+
+// quantidade de elementos disponíveis para o consumidor
+uint32_t spsc_ring_count(spsc_ring_t *ring);
+
+#endif // SPSC_RING_H
@@ -1,6 +1,14 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 
+// cada janela enviada pelo DMA são duas transações: 0x00 (Co = 0, só comandos) com a
+// faixa de colunas e de páginas, e 0x40 (Co = 0, só dados) seguido dos bytes da janela
+#define SSD1306_WINDOW_HEADER 8
+// custo aproximado de uma janela além dos dados: cabeçalho, dois endereços e STARTs
+#define SSD1306_WINDOW_COST (SSD1306_WINDOW_HEADER + 3)
+#define SSD1306_MAX_PAGES 8
+
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
   ssd->width = width;
   ssd->height = height;
@@ -11,37 +19,39 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->sent_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  ssd->sent_valid = false;
+  // pior caso: uma janela por página
+  ssd->dma_capacity = ssd->pages * SSD1306_WINDOW_HEADER + ssd->bufsize - 1;
+  ssd->dma_buffer = calloc(ssd->dma_capacity, sizeof(uint16_t));
+  ssd->dma_channel = -1;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  const uint8_t commands[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,             // endereçamento vertical: coluna a coluna, página a página
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, HEIGHT - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, 0x14,
+    SET_DISP | 0x01,
+  };
+  ssd1306_command_list(ssd, commands, sizeof(commands));
+  ssd1306_invalidate(ssd);
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_wait(ssd);
   ssd->port_buffer[1] = command;
   i2c_write_blocking(
     ssd->i2c_port,
@@ -52,20 +62,138 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count) {
+  uint8_t buf[33];
+  ssd1306_wait(ssd);
+  buf[0] = 0x00;                      // Co = 0, D/C# = 0: todos os bytes seguintes são comandos
+  while (count > 0) {
+    size_t n = count < sizeof(buf) - 1 ? count : sizeof(buf) - 1;
+    for (size_t i = 0; i < n; ++i)
+      buf[i + 1] = commands[i];
+    i2c_write_blocking(ssd->i2c_port, ssd->address, buf, n + 1, false);
+    commands += n;
+    count -= n;
+  }
+}
+
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  ssd1306_wait(ssd);
+  ssd1306_send_data_async(ssd);
+  ssd1306_wait(ssd);
+}
+
+void ssd1306_invalidate(ssd1306_t *ssd) {
+  ssd->sent_valid = false;
+}
+
+// acha, em cada página, a faixa de colunas que difere do último quadro enviado
+static bool ssd1306_find_dirty(ssd1306_t *ssd) {
+  bool any = false;
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    uint8_t x0 = 0xFF, x1 = 0;
+    for (uint8_t x = 0; x < ssd->width; ++x) {
+      size_t i = (size_t)(x << 3) + p + 1;
+      if (!ssd->sent_valid || ssd->ram_buffer[i] != ssd->sent_buffer[i]) {
+        if (x0 == 0xFF) x0 = x;
+        x1 = x;
+      }
+    }
+    ssd->dirty_x0[p] = x0;
+    ssd->dirty_x1[p] = x1;
+    any |= x0 != 0xFF;
+  }
+  return any;
+}
+
+// acrescenta em words uma janela de colunas x0..x1 e páginas p0..p1 e atualiza a cópia enviada
+static uint16_t *ssd1306_emit_window(ssd1306_t *ssd, uint16_t *words, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const uint8_t header[SSD1306_WINDOW_HEADER - 1] = { 0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1 };
+  for (size_t i = 0; i < sizeof(header); ++i)
+    *words++ = header[i];
+  words[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  *words++ = 0x40;
+  // endereçamento vertical: as páginas da coluna e depois a coluna seguinte
+  for (uint8_t x = x0; x <= x1; ++x) {
+    for (uint8_t p = p0; p <= p1; ++p) {
+      size_t i = (size_t)(x << 3) + p + 1;
+      *words++ = ssd->ram_buffer[i];
+      ssd->sent_buffer[i] = ssd->ram_buffer[i];
+    }
+  }
+  words[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  return words;
+}
+
+// agrupa páginas vizinhas numa janela só quando isso custa menos bytes que janelas separadas
+static size_t ssd1306_build_windows(ssd1306_t *ssd) {
+  uint16_t *words = ssd->dma_buffer;
+  int p0 = -1;
+  uint8_t x0 = 0, x1 = 0, p1 = 0;
+  for (uint8_t p = 0; p < ssd->pages; ++p) {
+    if (ssd->dirty_x0[p] > ssd->dirty_x1[p]) continue;
+    uint8_t nx0 = ssd->dirty_x0[p], nx1 = ssd->dirty_x1[p];
+    if (p0 >= 0 && p == p1 + 1) {
+      uint8_t mx0 = nx0 < x0 ? nx0 : x0, mx1 = nx1 > x1 ? nx1 : x1;
+      uint32_t merged = (uint32_t)(p - p0 + 1) * (mx1 - mx0 + 1);
+      uint32_t separate = (uint32_t)(p1 - p0 + 1) * (x1 - x0 + 1) + SSD1306_WINDOW_COST + (nx1 - nx0 + 1);
+      if (merged <= separate) {
+        x0 = mx0;
+        x1 = mx1;
+        p1 = p;
+        continue;
+      }
+    }
+    if (p0 >= 0) words = ssd1306_emit_window(ssd, words, x0, x1, (uint8_t)p0, p1);
+    p0 = p;
+    p1 = p;
+    x0 = nx0;
+    x1 = nx1;
+  }
+  if (p0 >= 0) words = ssd1306_emit_window(ssd, words, x0, x1, (uint8_t)p0, p1);
+  ssd->sent_valid = true;
+  return (size_t)(words - ssd->dma_buffer);
+}
+
+bool ssd1306_send_data_async(ssd1306_t *ssd) {
+  if (ssd1306_busy(ssd)) return false;
+  if (!ssd1306_find_dirty(ssd)) return true;     // nada mudou desde o último envio
+  if (ssd->dma_channel < 0) ssd->dma_channel = dma_claim_unused_channel(true);
+  size_t count = ssd1306_build_windows(ssd);
+
+  // mesmo preparo de i2c_write_blocking: endereço de destino com o bloco desabilitado
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  hw->enable = 0;
+  hw->tar = ssd->address;
+  hw->enable = 1;
+
+  // cada STOP encerra uma transação; a palavra seguinte na FIFO abre a próxima com um START
+  dma_channel_config c = dma_channel_get_default_config(ssd->dma_channel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(ssd->i2c_port, true));
+  dma_channel_configure(ssd->dma_channel, &c, &hw->data_cmd, ssd->dma_buffer, count, true);
+  return true;
+}
+
+bool ssd1306_busy(ssd1306_t *ssd) {
+  if (ssd->dma_channel < 0) return false;
+  if (dma_channel_is_busy(ssd->dma_channel)) return true;
+  // o DMA termina com até 16 bytes ainda na FIFO de transmissão do I2C
+  i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+  if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS))
+    return true;
+  // sem ACK as janelas se perderam: limpa o abort e reenvia o quadro inteiro na próxima vez
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    (void)hw->clr_tx_abrt;
+    ssd->sent_valid = false;
+  }
+  return false;
+}
+
+void ssd1306_wait(ssd1306_t *ssd) {
+  while (ssd1306_busy(ssd))
+    tight_loop_contents();
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
@@ -77,41 +205,53 @@ void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
     ssd->ram_buffer[index] &= ~(1 << pixel);
 }
 
-/*
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+  // o buffer inteiro de uma vez; o byte 0 é o controle 0x40 e fica intacto
+  memset(ssd->ram_buffer + 1, value ? 0xFF : 0x00, ssd->bufsize - 1);
 }
 
+void ssd1306_fill_rect(ssd1306_t *ssd, uint8_t x, uint8_t y, uint8_t width, uint8_t height, bool value) {
+  if (width == 0 || height == 0 || x >= ssd->width || y >= ssd->height)
+    return;
+  unsigned x_end = x + width < ssd->width ? x + width : ssd->width;
+  unsigned y_last = y + height - 1U < ssd->height ? y + height - 1U : ssd->height - 1U;
+  uint8_t p0 = y >> 3, p1 = (uint8_t)(y_last >> 3);
 
-
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
+  // máscara de cada página uma vez só; depois, um AND/OR por byte em cada coluna
+  uint8_t masks[SSD1306_MAX_PAGES];
+  for (uint8_t p = p0; p <= p1; ++p) {
+    uint8_t mask = 0xFF;
+    if (p == p0) mask &= (uint8_t)(0xFF << (y & 7));
+    if (p == p1) mask &= (uint8_t)(0xFF >> (7 - (y_last & 7)));
+    masks[p] = mask;
   }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
+  for (unsigned cx = x; cx < x_end; ++cx) {
+    uint8_t *column = &ssd->ram_buffer[(cx << 3) + 1];
+    for (uint8_t p = p0; p <= p1; ++p) {
+      if (value)
+        column[p] |= masks[p];
+      else
+        column[p] &= (uint8_t)~masks[p];
+    }
   }
+}
+
+void ssd1306_clear_rect(ssd1306_t *ssd, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+  ssd1306_fill_rect(ssd, x, y, width, height, false);
+}
 
+void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  if (width == 0 || height == 0)
+    return;
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    // borda e interior com o mesmo valor: o retângulo inteiro
+    ssd1306_fill_rect(ssd, left, top, width, height, value);
+    return;
   }
+  ssd1306_fill_rect(ssd, left, top, width, 1, value);
+  ssd1306_fill_rect(ssd, left, top + height - 1, width, 1, value);
+  ssd1306_fill_rect(ssd, left, top, 1, height, value);
+  ssd1306_fill_rect(ssd, left + width - 1, top, 1, height, value);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -144,13 +284,30 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  if (x0 <= x1)
+    ssd1306_fill_rect(ssd, x0, y, x1 - x0 + 1, 1, value);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  if (y0 <= y1)
+    ssd1306_fill_rect(ssd, x, y0, 1, y1 - y0 + 1, value);
+}
+
+// copia colunas de 8 pixels (bit 0 em cima, o formato das páginas) para a posição (x, y);
+// com y fora do limite de página cada coluna é deslocada e mesclada em duas páginas
+static void ssd1306_blit8(ssd1306_t *ssd, const uint8_t *columns, uint8_t count, uint8_t x, uint8_t y) {
+  if (y >= ssd->height)
+    return;
+  uint8_t page = y >> 3, shift = y & 7;
+  uint8_t keep_low = (uint8_t)~(0xFF << shift);        // linhas acima do glifo na primeira página
+  uint8_t keep_high = (uint8_t)(0xFF << shift);        // linhas abaixo do glifo na segunda página
+  bool second = shift && page + 1 < ssd->pages;
+  for (unsigned i = 0; i < count && x + i < ssd->width; ++i) {
+    uint8_t *column = &ssd->ram_buffer[((x + i) << 3) + 1];
+    column[page] = (column[page] & keep_low) | (uint8_t)(columns[i] << shift);
+    if (second)
+      column[page + 1] = (column[page + 1] & keep_high) | (uint8_t)(columns[i] >> (8 - shift));
+  }
 }
 
 // Função para desenhar um caractere
@@ -169,15 +326,8 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
   }
 
-  // Desenha o caractere na tela
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
-    }
-  }
+  // os glifos já estão em colunas de 8 pixels: o caractere inteiro é copiado byte a byte
+  ssd1306_blit8(ssd, &font[index], 8, x, y);
 }
 
 // Função para desenhar uma string
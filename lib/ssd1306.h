@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 
 #define WIDTH 128
 #define HEIGHT 64
@@ -32,15 +33,41 @@ typedef struct {
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t *sent_buffer;   // conteúdo da GDDRAM: o último quadro enviado, no layout de ram_buffer
+  bool sent_valid;        // false força o envio do quadro inteiro (início ou falha no barramento)
+  uint8_t dirty_x0[8];    // colunas alteradas de cada página no último envio (x0 > x1: página limpa)
+  uint8_t dirty_x1[8];
+  uint16_t *dma_buffer;   // janelas alteradas em palavras de IC_DATA_CMD, lidas pelo DMA
+  size_t dma_capacity;
+  int dma_channel;        // -1 até o primeiro envio assíncrono
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+// Envia vários comandos (com seus argumentos) numa única transação I2C
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t count);
 void ssd1306_send_data(ssd1306_t *ssd);
 
+// Envio assíncrono: ram_buffer é comparado com o último quadro enviado e só as janelas
+// alteradas (faixa de colunas por grupo de páginas) são copiadas para dma_buffer e
+// transmitidas pelo DMA direto no IC_DATA_CMD do I2C, sem ocupar a CPU. ram_buffer pode
+// ser redesenhado logo em seguida. Retorna false (e não envia nada) se o envio anterior
+// ainda está em andamento
+bool ssd1306_send_data_async(ssd1306_t *ssd);
+// Faz o próximo envio transmitir o quadro inteiro
+void ssd1306_invalidate(ssd1306_t *ssd);
+// true enquanto um envio assíncrono ocupa o barramento
+bool ssd1306_busy(ssd1306_t *ssd);
+// Espera o fim do envio em andamento; as funções bloqueantes chamam antes de usar o barramento
+void ssd1306_wait(ssd1306_t *ssd);
+
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
+// Primitivas por byte: cada coluna de 8 linhas é um byte de ram_buffer, então faixas e
+// retângulos são aplicados com uma máscara por página. Fora da tela, recortam
+void ssd1306_fill_rect(ssd1306_t *ssd, uint8_t x, uint8_t y, uint8_t width, uint8_t height, bool value);
+void ssd1306_clear_rect(ssd1306_t *ssd, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
@@ -21,6 +21,7 @@
 #define MEM_ALIGNMENT               4
 #define MEM_SIZE                    4000*8
 #define MEMP_NUM_TCP_SEG            32
+#define MEMP_NUM_TCP_PCB            6       // 4 conexões HTTP (HTTPD_MAX_CONNS) + respostas 503 + folga
 #define MEMP_NUM_ARP_QUEUE          10
 #define PBUF_POOL_SIZE              24
 #define LWIP_ARP                    1
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+"""Gera a tabela de altitude de lib/altitude.c.
+
+Uso: altitude_table.py
+
+Cada entrada é a altitude (cm) da fórmula barométrica 44330 * (1 - r^0.1903) para
+a razão r = p / p0 de 0.5 a 1.125, em passos de 1/256. A curva é convexa, então a
+interpolação linear fica acima dela no meio de cada intervalo; cada ponto é deslocado
+para baixo pela metade desse desvio (h'' * passo^2 / 16), dividindo o erro entre os
+nós e o meio dos intervalos. Cole a saída em lib/altitude.c.
+"""
+
+R_MIN = 0.5
+R_STEP = 1 / 256
+ENTRIES = 161
+
+
+def main():
+    values = []
+    for i in range(ENTRIES):
+        r = R_MIN + i * R_STEP
+        h = 44330.0 * (1.0 - r ** 0.1903)
+        h2 = 44330.0 * 0.1903 * (1.0 - 0.1903) * r ** (0.1903 - 2.0)  # segunda derivada
+        values.append(round((h - h2 * R_STEP * R_STEP / 16.0) * 100))
+    for i in range(0, ENTRIES, 8):
+        print("    " + " ".join("%d," % v for v in values[i:i + 8]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Gera um cabeçalho C com as páginas web embutidas, originais e comprimidas com gzip.
+
+Uso: embed_assets.py <saida.h> <arquivo>=<SIMBOLO>[:<content-type>] ...
+
+Para cada arquivo é emitida uma constante web_asset_t <SIMBOLO> com o conteúdo
+original, a versão gzip (nível 9, sem data, para a saída ser reprodutível) e uma
+ETag derivada do SHA-256 do conteúdo original.
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+
+def c_bytes(data, indent="    ", per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        chunk = data[i:i + per_line]
+        lines.append(indent + ", ".join("0x%02x" % b for b in chunk) + ",")
+    return "\n".join(lines)
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write(__doc__)
+        return 1
+
+    output = argv[1]
+    out = [
+        "// Gerado por tools/embed_assets.py a partir de web/; não editar.",
+        "",
+        "#ifndef WEB_ASSETS_H",
+        "#define WEB_ASSETS_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "typedef struct {",
+        "    const char *content_type;",
+        "    const uint8_t *data;       // conteúdo original",
+        "    uint32_t len;",
+        "    const uint8_t *gz;         // conteúdo comprimido (Content-Encoding: gzip)",
+        "    uint32_t gz_len;",
+        "    const char *etag;          // hash do conteúdo, sem aspas",
+        "} web_asset_t;",
+        "",
+    ]
+
+    for spec in argv[2:]:
+        path, _, rest = spec.partition("=")
+        symbol, _, content_type = rest.partition(":")
+        content_type = content_type or "text/html; charset=utf-8"
+        with open(path, "rb") as f:
+            data = f.read()
+        gz = gzip.compress(data, compresslevel=9, mtime=0)
+        etag = hashlib.sha256(data).hexdigest()[:16]
+        name = symbol.lower()
+
+        out.append("// %s: %d bytes, %d com gzip" % (os.path.basename(path), len(data), len(gz)))
+        out.append("static const uint8_t %s_data[%d] = {" % (name, len(data)))
+        out.append(c_bytes(data))
+        out.append("};")
+        out.append("static const uint8_t %s_gz[%d] = {" % (name, len(gz)))
+        out.append(c_bytes(gz))
+        out.append("};")
+        out.append("static const web_asset_t %s = {" % symbol)
+        out.append('    "%s", %s_data, %d, %s_gz, %d, "%s",' % (content_type, name, len(data), name, len(gz), etag))
+        out.append("};")
+        out.append("")
+
+    out.append("#endif // WEB_ASSETS_H")
+    out.append("")
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, "w") as f:
+        f.write("\n".join(out))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,21 @@
+# Páginas web embutidas no binário: web/*.html -> generated/web_assets.h no diretório de
+# build, com as versões originais, comprimidas com gzip e a ETag de cada página.
+
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+set(ESTACAO_WEB_DIR ${CMAKE_CURRENT_LIST_DIR})
+set(ESTACAO_WEB_INCLUDE_DIR ${CMAKE_BINARY_DIR})
+set(ESTACAO_WEB_HEADER ${ESTACAO_WEB_INCLUDE_DIR}/generated/web_assets.h)
+
+add_custom_command(
+    OUTPUT ${ESTACAO_WEB_HEADER}
+    COMMAND ${Python3_EXECUTABLE} ${ESTACAO_WEB_DIR}/../tools/embed_assets.py ${ESTACAO_WEB_HEADER}
+            ${ESTACAO_WEB_DIR}/index.html=PAGINA_PRINCIPAL
+            ${ESTACAO_WEB_DIR}/settings.html=PAGINA_CONFIGURACOES
+    DEPENDS ${ESTACAO_WEB_DIR}/../tools/embed_assets.py
+            ${ESTACAO_WEB_DIR}/index.html
+            ${ESTACAO_WEB_DIR}/settings.html
+    COMMENT "Comprimindo as paginas web"
+    VERBATIM
+)
+add_custom_target(estacao_web_assets DEPENDS ${ESTACAO_WEB_HEADER})